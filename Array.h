@@ -2,6 +2,9 @@
 
 #include <algorithm>
 #include <compare>
+#include <cstddef>
+#include <cstring>
+#include <functional>
 #include <initializer_list>
 #include <iterator>
 #include <limits>
@@ -11,16 +14,58 @@
 #include <type_traits>
 #include <utility>
 
+#include "ArrayIterator.h"
+#include "ArrayView.h"
+#include "GrowthPolicy.h"
+#include "Instrumentation.h"
+#include "Memory.h"
+#include "Simd.h"
+
+// Buffers of at least this many bytes are backed by page mappings, which grow in place,
+// when T is trivially relocatable and Array uses std::allocator.
+#ifndef ABOUTTT_ARRAY_MAPPING_THRESHOLD
+#define ABOUTTT_ARRAY_MAPPING_THRESHOLD (size_t(1) << 20)
+#endif
+
 namespace abouttt
 {
 
-template <typename T>
-class ArrayIterator;
+// Room for N elements inside the object; empty when N is zero.
+template <typename T, size_t N>
+struct ArrayInlineStorage
+{
+	T* Data() noexcept
+	{
+		return reinterpret_cast<T*>(mBytes);
+	}
+
+	alignas(T) std::byte mBytes[sizeof(T) * N];
+};
 
 template <typename T>
+struct ArrayInlineStorage<T, 0>
+{
+	T* Data() noexcept
+	{
+		return nullptr;
+	}
+};
+
+// With a non-zero InlineCapacity, up to that many elements are kept inside the
+// object and the heap is used only past it. Moving or swapping an inline array
+// then moves its elements instead of a pointer.
+template <typename T, typename Allocator = std::allocator<T>, typename Growth = DefaultGrowth, size_t InlineCapacity = 0>
 class Array
 {
+	static_assert(std::is_same_v<typename Allocator::value_type, T>, "Allocator::value_type must be T");
+
+private:
+	using AllocatorTraits = std::allocator_traits<Allocator>;
+
+	static constexpr bool NOTHROW_TAKE_STORAGE = InlineCapacity == 0 || std::is_nothrow_move_constructible_v<T>;
+
 public:
+	using AllocatorType = Allocator;
 	using Iterator = ArrayIterator<T>;
 	using ConstIterator = ArrayIterator<const T>;
 	using ReverseIterator = std::reverse_iterator<Iterator>;
@@ -28,6 +73,8 @@ public:
 
 public:
 	static constexpr size_t INDEX_NONE = std::numeric_limits<size_t>::max();
+	static constexpr size_t MAPPING_THRESHOLD = ABOUTTT_ARRAY_MAPPING_THRESHOLD;
+	static constexpr size_t INLINE_CAPACITY = InlineCapacity;
 
 public:
 	Array() noexcept
@@ -35,32 +82,61 @@ public:
 	{
 	}
 
-	explicit Array(size_t capacity)
-		: mData(capacity > 0 ? static_cast<T*>(::operator new(sizeof(T) * capacity)) : nullptr)
+	explicit Array(const Allocator& alloc) noexcept
+		: Array(0, alloc)
+	{
+	}
+
+	explicit Array(size_t capacity, const Allocator& alloc = Allocator())
+		: mAllocator(alloc)
+		, mData(allocateStorage(roundCapacity(capacity)))
 		, mCount(0)
-		, mCapacity(capacity)
+		, mCapacity(roundCapacity(capacity))
 	{
 	}
 
-	Array(std::initializer_list<T> ilist)
-		: Array(ilist.size())
+	Array(std::initializer_list<T> ilist, const Allocator& alloc = Allocator())
+		: Array(ilist.size(), alloc)
 	{
 		std::uninitialized_copy(ilist.begin(), ilist.end(), mData);
 		mCount = ilist.size();
 	}
 
 	Array(const Array& other)
-		: Array(other.mCount)
+		: Array(other, AllocatorTraits::select_on_container_copy_construction(other.mAllocator))
+	{
+	}
+
+	Array(const Array& other, const Allocator& alloc)
+		: Array(other.mCount, alloc)
 	{
 		std::uninitialized_copy(other.mData, other.mData + other.mCount, mData);
 		mCount = other.mCount;
 	}
 
-	Array(Array&& other) noexcept
-		: mData(std::exchange(other.mData, nullptr))
-		, mCount(std::exchange(other.mCount, 0))
-		, mCapacity(std::exchange(other.mCapacity, 0))
+	Array(Array&& other) noexcept(NOTHROW_TAKE_STORAGE)
+		: mAllocator(std::move(other.mAllocator))
+		, mData(mInline.Data())
+		, mCount(0)
+		, mCapacity(InlineCapacity)
 	{
+		takeStorage(other);
+	}
+
+	Array(Array&& other, const Allocator& alloc)
+		: Array(alloc)
+	{
+		if (other.IsInline() || mAllocator == other.mAllocator)
+		{
+			takeStorage(other);
+		}
+		else
+		{
+			reallocate(other.mCount);
+			std::uninitialized_move_n(other.mData, other.mCount, mData);
+			mCount = other.mCount;
+			other.Clear();
+		}
 	}
 
 	~Array()
@@ -73,40 +149,61 @@ public:
 	{
 		if (this != &other)
 		{
-			Array temp(other);
-			Swap(temp);
+			if constexpr (AllocatorTraits::propagate_on_container_copy_assignment::value)
+			{
+				if (mAllocator != other.mAllocator)
+				{
+					cleanup();
+				}
+				mAllocator = other.mAllocator;
+			}
+			Array temp(other, mAllocator);
+			swapStorage(temp);
 		}
 		return *this;
 	}
 
-	Array& operator=(Array&& other) noexcept
+	Array& operator=(Array&& other) noexcept(NOTHROW_TAKE_STORAGE && (
+		AllocatorTraits::propagate_on_container_move_assignment::value ||
+		AllocatorTraits::is_always_equal::value))
 	{
 		if (this != &other)
 		{
-			cleanup();
-			mData = std::exchange(other.mData, nullptr);
-			mCount = std::exchange(other.mCount, 0);
-			mCapacity = std::exchange(other.mCapacity, 0);
+			if constexpr (AllocatorTraits::propagate_on_container_move_assignment::value)
+			{
+				cleanup();
+				mAllocator = std::move(other.mAllocator);
+				takeStorage(other);
+			}
+			else
+			{
+				Array temp(std::move(other), mAllocator);
+				swapStorage(temp);
+			}
 		}
 		return *this;
 	}
 
 	Array& operator=(std::initializer_list<T> ilist)
 	{
-		Array temp(ilist);
-		Swap(temp);
+		Array temp(ilist, mAllocator);
+		swapStorage(temp);
 		return *this;
 	}
 
-	T& operator[](size_t index)
+	T& operator[](size_t index) noexcept(!ABOUTTT_ARRAY_BOUNDS_CHECK)
 	{
+#if ABOUTTT_ARRAY_BOUNDS_CHECK
 		checkRange(index);
+#endif
 		return mData[index];
 	}
 
-	const T& operator[](size_t index) const
+	const T& operator[](size_t index) const noexcept(!ABOUTTT_ARRAY_BOUNDS_CHECK)
 	{
+#if ABOUTTT_ARRAY_BOUNDS_CHECK
 		checkRange(index);
+#endif
 		return mData[index];
 	}
 
@@ -123,6 +220,16 @@ public:
 		return mCount == other.mCount && std::equal(mData, mData + mCount, other.mData);
 	}
 
+	operator ArrayView<T>() noexcept
+	{
+		return View();
+	}
+
+	operator ArrayView<const T>() const noexcept
+	{
+		return View();
+	}
+
 public:
 	void Add(const T& value)
 	{
@@ -134,6 +241,19 @@ public:
 		Emplace(std::move(value));
 	}
 
+	// Appends count elements whose contents are indeterminate and returns a pointer
+	// to the first, for filling directly, e.g. from read().
+	T* AddUninitialized(size_t count)
+	{
+		static_assert(std::is_trivially_default_constructible_v<T> && std::is_trivially_destructible_v<T>,
+			"AddUninitialized requires a trivial type");
+		ensureCapacity(mCount + count);
+		T* first = mData + mCount;
+		std::uninitialized_default_construct_n(first, count);
+		mCount += count;
+		return first;
+	}
+
 	void Append(const Array& source)
 	{
 		Insert(mCount, source);
@@ -154,6 +274,31 @@ public:
 		Insert(mCount, ptr, count);
 	}
 
+	void Append(ArrayView<const T> source)
+	{
+		Insert(mCount, source);
+	}
+
+	T& At(size_t index)
+	{
+		checkRange(index);
+		return mData[index];
+	}
+
+	const T& At(size_t index) const
+	{
+		checkRange(index);
+		return mData[index];
+	}
+
+	// Index of an element equal to value in an array sorted by comp, or INDEX_NONE.
+	template <typename Compare = std::less<>>
+	size_t BinarySearch(const T& value, Compare comp = Compare()) const
+	{
+		size_t index = LowerBound(value, comp);
+		return index != mCount && !comp(value, mData[index]) ? index : INDEX_NONE;
+	}
+
 	size_t Capacity() const noexcept
 	{
 		return mCapacity;
@@ -206,8 +351,27 @@ public:
 
 		if (index < mCount)
 		{
-			std::uninitialized_move_n(mData + mCount - 1, 1, mData + mCount);
-			std::move_backward(mData + index, mData + mCount - 1, mData + mCount);
+			ABOUTTT_INSTRUMENT(Shift, "Array", this, sizeof(T) * (mCount - index), mCount - index);
+			if constexpr (IsTriviallyRelocatableV<T>)
+			{
+				alignas(T) std::byte storage[sizeof(T)];
+				T* temp = std::construct_at(reinterpret_cast<T*>(storage), std::forward<Args>(args)...);
+				std::memmove(static_cast<void*>(mData + index + 1), static_cast<const void*>(mData + index), sizeof(T) * (mCount - index));
+				std::memcpy(static_cast<void*>(mData + index), static_cast<const void*>(temp), sizeof(T));
+				++mCount;
+				return index;
+			}
+			else
+			{
+				// Built first, so that a throwing constructor leaves the array as it
+				// was and args may refer to an element that is about to move.
+				T temp(std::forward<Args>(args)...);
+				std::uninitialized_move_n(mData + mCount - 1, 1, mData + mCount);
+				++mCount;
+				std::move_backward(mData + index, mData + mCount - 2, mData + mCount - 1);
+				mData[index] = std::move(temp);
+				return index;
+			}
 		}
 		std::construct_at(mData + index, std::forward<Args>(args)...);
 		++mCount;
@@ -217,8 +381,16 @@ public:
 
 	size_t Find(const T& value) const
 	{
-		const T* it = std::find(mData, mData + mCount, value);
-		return it != mData + mCount ? static_cast<size_t>(it - mData) : INDEX_NONE;
+		if constexpr (IsSimdSearchableV<T>)
+		{
+			size_t index = SimdSearch::Find(mData, mCount, value);
+			return index != mCount ? index : INDEX_NONE;
+		}
+		else
+		{
+			const T* it = std::find(mData, mData + mCount, value);
+			return it != mData + mCount ? static_cast<size_t>(it - mData) : INDEX_NONE;
+		}
 	}
 
 	template <typename Predicate>
@@ -230,14 +402,22 @@ public:
 
 	size_t FindLast(const T& value) const
 	{
-		for (size_t i = mCount; i-- > 0; )
+		if constexpr (IsSimdSearchableV<T>)
+		{
+			size_t index = SimdSearch::FindLast(mData, mCount, value);
+			return index != mCount ? index : INDEX_NONE;
+		}
+		else
 		{
-			if (mData[i] == value)
+			for (size_t i = mCount; i-- > 0; )
 			{
-				return i;
+				if (mData[i] == value)
+				{
+					return i;
+				}
 			}
+			return INDEX_NONE;
 		}
-		return INDEX_NONE;
 	}
 
 	template <typename Predicate>
@@ -253,6 +433,21 @@ public:
 		return INDEX_NONE;
 	}
 
+	Allocator GetAllocator() const noexcept
+	{
+		return mAllocator;
+	}
+
+	T& GetUnchecked(size_t index) noexcept
+	{
+		return mData[index];
+	}
+
+	const T& GetUnchecked(size_t index) const noexcept
+	{
+		return mData[index];
+	}
+
 	size_t Insert(size_t index, const T& value)
 	{
 		return EmplaceAt(index, value);
@@ -285,11 +480,40 @@ public:
 		return insertImpl(index, ptr, count);
 	}
 
+	// Source may be a view of this array.
+	size_t Insert(size_t index, ArrayView<const T> source)
+	{
+		std::less<const T*> less;
+		if (!less(source.Data(), mData) && less(source.Data(), mData + mCount))
+		{
+			// Growing or shifting would move the elements out from under it.
+			Array copy(mAllocator);
+			copy.Append(source.Data(), source.Count());
+			return insertImpl(index, copy.mData, copy.mCount);
+		}
+		return insertImpl(index, source.Data(), source.Count());
+	}
+
 	bool IsEmpty() const noexcept
 	{
 		return mCount == 0;
 	}
 
+	// Whether the elements are in the object's inline storage. Always false when
+	// InlineCapacity is zero.
+	bool IsInline() const noexcept
+	{
+		return InlineCapacity > 0 && isInline(mCapacity);
+	}
+
+	// Index of the first element not less than value in an array sorted by comp, or
+	// Count() when there is none.
+	template <typename Compare = std::less<>>
+	size_t LowerBound(const T& value, Compare comp = Compare()) const
+	{
+		return static_cast<size_t>(std::lower_bound(mData, mData + mCount, value, comp) - mData);
+	}
+
 	bool Remove(const T& value)
 	{
 		size_t index = Find(value);
@@ -318,14 +542,133 @@ public:
 	void RemoveAt(size_t index)
 	{
 		checkRange(index);
-		std::destroy_at(mData + index);
-		if (index < mCount - 1)
+		ABOUTTT_INSTRUMENT(Shift, "Array", this, sizeof(T) * (mCount - index - 1), mCount - index - 1);
+		if constexpr (IsTriviallyRelocatableV<T>)
+		{
+			std::destroy_at(mData + index);
+			std::memmove(static_cast<void*>(mData + index), static_cast<const void*>(mData + index + 1), sizeof(T) * (mCount - index - 1));
+		}
+		else
 		{
 			std::move(mData + index + 1, mData + mCount, mData + index);
+			std::destroy_at(mData + mCount - 1);
+		}
+		--mCount;
+	}
+
+	// Removes count consecutive elements starting at index, shifting the tail once.
+	void RemoveAt(size_t index, size_t count)
+	{
+		checkRange(index, true);
+		if (count > mCount - index)
+		{
+			throw std::out_of_range("Array index out of range");
+		}
+
+		if (count == 0)
+		{
+			return;
+		}
+
+		ABOUTTT_INSTRUMENT(Shift, "Array", this, sizeof(T) * (mCount - index - count), mCount - index - count);
+		if constexpr (IsTriviallyRelocatableV<T>)
+		{
+			std::destroy_n(mData + index, count);
+			std::memmove(static_cast<void*>(mData + index), static_cast<const void*>(mData + index + count), sizeof(T) * (mCount - index - count));
+		}
+		else
+		{
+			std::move(mData + index + count, mData + mCount, mData + index);
+			std::destroy_n(mData + mCount - count, count);
+		}
+		mCount -= count;
+	}
+
+	// Moves the last element into the gap instead of shifting; does not preserve order.
+	void RemoveAtSwap(size_t index)
+	{
+		checkRange(index);
+		size_t last = mCount - 1;
+		if constexpr (IsTriviallyRelocatableV<T>)
+		{
+			std::destroy_at(mData + index);
+			if (index != last)
+			{
+				std::memcpy(static_cast<void*>(mData + index), static_cast<const void*>(mData + last), sizeof(T));
+			}
+		}
+		else
+		{
+			if (index != last)
+			{
+				mData[index] = std::move(mData[last]);
+			}
+			std::destroy_at(mData + last);
 		}
 		--mCount;
 	}
 
+	// Removes the elements at the given strictly ascending indices in a single pass.
+	// Throws, leaving the array untouched, if the indices are unsorted or out of range.
+	size_t RemoveIndices(const size_t* sortedIndices, size_t count)
+	{
+		for (size_t i = 0; i < count; ++i)
+		{
+			checkRange(sortedIndices[i]);
+			if (i > 0 && sortedIndices[i] <= sortedIndices[i - 1])
+			{
+				throw std::out_of_range("Array indices must be strictly ascending");
+			}
+		}
+
+		if (count == 0)
+		{
+			return 0;
+		}
+
+		size_t write = sortedIndices[0];
+		ABOUTTT_INSTRUMENT(Shift, "Array", this, sizeof(T) * (mCount - write - count), mCount - write - count);
+		for (size_t i = 0; i < count; ++i)
+		{
+			size_t keepBegin = sortedIndices[i] + 1;
+			size_t keepEnd = i + 1 < count ? sortedIndices[i + 1] : mCount;
+			if constexpr (IsTriviallyRelocatableV<T>)
+			{
+				std::destroy_at(mData + sortedIndices[i]);
+				std::memmove(static_cast<void*>(mData + write), static_cast<const void*>(mData + keepBegin), sizeof(T) * (keepEnd - keepBegin));
+			}
+			else
+			{
+				std::move(mData + keepBegin, mData + keepEnd, mData + write);
+			}
+			write += keepEnd - keepBegin;
+		}
+
+		if constexpr (!IsTriviallyRelocatableV<T>)
+		{
+			std::destroy_n(mData + write, count);
+		}
+		mCount = write;
+		return count;
+	}
+
+	size_t RemoveIndices(std::initializer_list<size_t> sortedIndices)
+	{
+		return RemoveIndices(sortedIndices.begin(), sortedIndices.size());
+	}
+
+	// Swaps the last element into the gap left by the first element equal to value.
+	bool RemoveSwap(const T& value)
+	{
+		size_t index = Find(value);
+		if (index != INDEX_NONE)
+		{
+			RemoveAtSwap(index);
+			return true;
+		}
+		return false;
+	}
+
 	void Reserve(size_t newCapacity)
 	{
 		if (newCapacity > mCapacity)
@@ -334,25 +677,34 @@ public:
 		}
 	}
 
+	// New elements are value-initialized in place.
 	void Resize(size_t newCount)
 	{
-		Resize(newCount, T());
+		resizeWith(newCount, [](T* first, size_t count) { std::uninitialized_value_construct_n(first, count); });
 	}
 
 	void Resize(size_t newCount, const T& value)
 	{
-		if (newCount > mCount)
-		{
-			ensureCapacity(newCount);
-			std::uninitialized_fill_n(mData + mCount, newCount - mCount, value);
-		}
-		else if (newCount < mCount)
-		{
-			std::destroy_n(mData + newCount, mCount - newCount);
-		}
-		mCount = newCount;
+		resizeWith(newCount, [&value](T* first, size_t count) { std::uninitialized_fill_n(first, count, value); });
+	}
+
+	// New elements are default-initialized, which leaves trivial types indeterminate
+	// instead of zeroing them.
+	void ResizeDefaultInit(size_t newCount)
+	{
+		resizeWith(newCount, [](T* first, size_t count) { std::uninitialized_default_construct_n(first, count); });
+	}
+
+	// Like ResizeDefaultInit, restricted to trivial types so that the new contents
+	// are known to be indeterminate.
+	void ResizeUninitialized(size_t newCount)
+	{
+		static_assert(std::is_trivially_default_constructible_v<T> && std::is_trivially_destructible_v<T>,
+			"ResizeUninitialized requires a trivial type");
+		ResizeDefaultInit(newCount);
 	}
 
+	// Moves the elements back inline once they fit again.
 	void Shrink()
 	{
 		if (mCapacity > mCount)
@@ -361,17 +713,54 @@ public:
 		}
 	}
 
+	ArrayView<T> Slice(size_t offset, size_t count)
+	{
+		return View().Slice(offset, count);
+	}
+
+	ArrayView<const T> Slice(size_t offset, size_t count) const
+	{
+		return View().Slice(offset, count);
+	}
+
 	template <typename Compare>
 	void Sort(Compare comp)
 	{
 		std::sort(mData, mData + mCount, comp);
 	}
 
-	void Swap(Array& other) noexcept
+	template <typename Compare>
+	void StableSort(Compare comp)
 	{
-		std::swap(mData, other.mData);
-		std::swap(mCount, other.mCount);
-		std::swap(mCapacity, other.mCapacity);
+		std::stable_sort(mData, mData + mCount, comp);
+	}
+
+	void Swap(Array& other) noexcept(NOTHROW_TAKE_STORAGE)
+	{
+		if constexpr (AllocatorTraits::propagate_on_container_swap::value)
+		{
+			std::swap(mAllocator, other.mAllocator);
+		}
+		swapStorage(other);
+	}
+
+	// Index of the first element greater than value in an array sorted by comp, or
+	// Count() when there is none.
+	template <typename Compare = std::less<>>
+	size_t UpperBound(const T& value, Compare comp = Compare()) const
+	{
+		return static_cast<size_t>(std::upper_bound(mData, mData + mCount, value, comp) - mData);
+	}
+
+	// Valid until the array reallocates or is destroyed.
+	ArrayView<T> View() noexcept
+	{
+		return ArrayView<T>(mData, mCount);
+	}
+
+	ArrayView<const T> View() const noexcept
+	{
+		return ArrayView<const T>(mData, mCount);
 	}
 
 public: // Iterators for range-based loop support.
@@ -428,9 +817,7 @@ private:
 	{
 		if (minCapacity > mCapacity)
 		{
-			size_t grow = mCapacity + (mCapacity >> 1); // Grow by 1.5x
-			size_t newCapacity = std::max(minCapacity, mCapacity == 0 ? 8 : grow);
-			reallocate(newCapacity);
+			reallocate(Growth::Grow(mCapacity, minCapacity, sizeof(T)));
 		}
 	}
 
@@ -447,8 +834,50 @@ private:
 
 		if (index < mCount)
 		{
-			std::uninitialized_move_n(mData + mCount - count, count, mData + mCount);
-			std::move_backward(mData + index, mData + mCount - count, mData + mCount);
+			size_t tailCount = mCount - index;
+			ABOUTTT_INSTRUMENT(Shift, "Array", this, sizeof(T) * tailCount, tailCount);
+			if constexpr (IsTriviallyRelocatableV<T>)
+			{
+				std::memmove(static_cast<void*>(mData + index + count), static_cast<const void*>(mData + index), sizeof(T) * tailCount);
+				try
+				{
+					std::uninitialized_copy_n(ptr, count, mData + index);
+				}
+				catch (...)
+				{
+					std::memmove(static_cast<void*>(mData + index), static_cast<const void*>(mData + index + count), sizeof(T) * tailCount);
+					throw;
+				}
+				mCount += count;
+				return index;
+			}
+			// Slots below the old end stay alive and are assigned to, so a throwing
+			// copy never leaves a counted slot destroyed.
+			else if (count < tailCount)
+			{
+				std::uninitialized_move_n(mData + mCount - count, count, mData + mCount);
+				mCount += count;
+				std::move_backward(mData + index, mData + mCount - 2 * count, mData + mCount - count);
+				std::copy_n(ptr, count, mData + index);
+				return index;
+			}
+			else
+			{
+				T* oldEnd = mData + mCount;
+				std::uninitialized_copy_n(ptr + tailCount, count - tailCount, oldEnd);
+				try
+				{
+					std::uninitialized_move_n(mData + index, tailCount, mData + index + count);
+				}
+				catch (...)
+				{
+					std::destroy_n(oldEnd, count - tailCount);
+					throw;
+				}
+				mCount += count;
+				std::copy_n(ptr, tailCount, mData + index);
+				return index;
+			}
 		}
 		std::uninitialized_copy_n(ptr, count, mData + index);
 		mCount += count;
@@ -469,128 +898,196 @@ private:
 			return;
 		}
 
-		T* newData = static_cast<T*>(::operator new(sizeof(T) * newCapacity));
 		size_t newCount = std::min(mCount, newCapacity);
+		newCapacity = roundCapacity(newCapacity);
+		if (newCapacity == mCapacity)
+		{
+			return;
+		}
+
+#if ABOUTTT_HAS_PAGE_MAPPING
+		if (isMapped(mCapacity) && isMapped(newCapacity))
+		{
+			std::destroy_n(mData + newCount, mCount - newCount);
+			mCount = newCount;
+
+			void* remapped = RemapPages(mData, mappedBytes(mCapacity), mappedBytes(newCapacity));
+			if (remapped)
+			{
+				RecordReallocation<Growth>(sizeof(T) * mCapacity, sizeof(T) * newCapacity, 0, sizeof(T) * mCount);
+				ABOUTTT_INSTRUMENT(Reallocate, "Array", this, 0, sizeof(T) * newCapacity);
+				mData = static_cast<T*>(remapped);
+				mCapacity = newCapacity;
+				return;
+			}
+		}
+#endif
+
+		T* newData = allocateStorage(newCapacity);
 
 		if (mData)
 		{
-			std::uninitialized_move_n(mData, newCount, newData);
-			std::destroy_n(mData, mCount);
-			::operator delete(mData);
+			RelocateN(mData, newCount, newData);
+			std::destroy_n(mData + newCount, mCount - newCount);
+			deallocateStorage(mData, mCapacity);
 		}
+		RecordReallocation<Growth>(sizeof(T) * mCapacity, sizeof(T) * newCapacity, sizeof(T) * newCount, sizeof(T) * newCount);
+		ABOUTTT_INSTRUMENT(Reallocate, "Array", this, sizeof(T) * newCount, sizeof(T) * newCapacity);
 
 		mData = newData;
 		mCount = newCount;
 		mCapacity = newCapacity;
 	}
 
-	void cleanup() noexcept
+	// Capacities up to InlineCapacity, including zero, need no allocation.
+	static bool isInline(size_t capacity) noexcept
 	{
-		if (mData)
-		{
-			std::destroy_n(mData, mCount);
-			::operator delete(mData);
-			mData = nullptr;
-			mCount = 0;
-			mCapacity = 0;
-		}
+		return capacity <= InlineCapacity;
 	}
 
-private:
-	T* mData;
-	size_t mCount;
-	size_t mCapacity;
-};
-
-template <typename T>
-class ArrayIterator
-{
-public:
-	ArrayIterator() noexcept
-		: mPtr(nullptr)
+	static bool isMapped(size_t capacity) noexcept
 	{
+		if constexpr (ABOUTTT_HAS_PAGE_MAPPING && IsTriviallyRelocatableV<T> && std::is_same_v<Allocator, std::allocator<T>>)
+		{
+			return !isInline(capacity) && capacity >= (MAPPING_THRESHOLD + sizeof(T) - 1) / sizeof(T);
+		}
+		else
+		{
+			return false;
+		}
 	}
 
-	explicit ArrayIterator(T* ptr) noexcept
-		: mPtr(ptr)
+#if ABOUTTT_HAS_PAGE_MAPPING
+	static size_t mappedBytes(size_t capacity) noexcept
 	{
+		size_t pageSize = PageSize();
+		return (capacity * sizeof(T) + pageSize - 1) / pageSize * pageSize;
 	}
+#endif
 
-	template<typename U = T, typename = std::enable_if_t<std::is_const_v<U>>>
-	ArrayIterator(const ArrayIterator<std::remove_const_t<T>>& other) noexcept
-		: mPtr(other.mPtr)
+	// Mapped buffers always span whole pages, so capacity is rounded up to fill them.
+	static size_t roundCapacity(size_t capacity) noexcept
 	{
-	}
+		if (isInline(capacity))
+		{
+			return InlineCapacity;
+		}
 
-public:
-	T& operator*() const noexcept
-	{
-		return *mPtr;
+#if ABOUTTT_HAS_PAGE_MAPPING
+		if (isMapped(capacity))
+		{
+			return mappedBytes(capacity) / sizeof(T);
+		}
+#endif
+		return capacity;
 	}
 
-	T* operator->() const noexcept
+	T* allocateStorage(size_t capacity)
 	{
-		return mPtr;
-	}
+		if (isInline(capacity))
+		{
+			return mInline.Data();
+		}
 
-	T& operator[](size_t index) const noexcept
-	{
-		return *(mPtr + index);
-	}
+#if ABOUTTT_HAS_PAGE_MAPPING
+		if (isMapped(capacity))
+		{
+			void* pages = MapPages(mappedBytes(capacity));
+			if (!pages)
+			{
+				throw std::bad_alloc();
+			}
+			return static_cast<T*>(pages);
+		}
+#endif
 
-	ArrayIterator& operator++() noexcept
-	{
-		++mPtr;
-		return *this;
+		return AllocatorTraits::allocate(mAllocator, capacity);
 	}
 
-	ArrayIterator operator++(int) noexcept
+	void deallocateStorage(T* data, size_t capacity) noexcept
 	{
-		ArrayIterator temp = *this;
-		++mPtr;
-		return temp;
-	}
+		if (isInline(capacity))
+		{
+			return;
+		}
 
-	ArrayIterator& operator--() noexcept
-	{
-		--mPtr;
-		return *this;
-	}
+#if ABOUTTT_HAS_PAGE_MAPPING
+		if (isMapped(capacity))
+		{
+			UnmapPages(data, mappedBytes(capacity));
+			return;
+		}
+#endif
 
-	ArrayIterator operator--(int) noexcept
-	{
-		ArrayIterator temp = *this;
-		--mPtr;
-		return temp;
+		AllocatorTraits::deallocate(mAllocator, data, capacity);
 	}
 
-	ArrayIterator operator+(size_t n) const noexcept
+	template <typename Construct>
+	void resizeWith(size_t newCount, Construct construct)
 	{
-		return ArrayIterator(mPtr + n);
+		if (newCount > mCount)
+		{
+			ensureCapacity(newCount);
+			construct(mData + mCount, newCount - mCount);
+		}
+		else if (newCount < mCount)
+		{
+			std::destroy_n(mData + newCount, mCount - newCount);
+		}
+		mCount = newCount;
 	}
 
-	ArrayIterator operator-(size_t n) const noexcept
+	void swapStorage(Array& other) noexcept(NOTHROW_TAKE_STORAGE)
 	{
-		return ArrayIterator(mPtr - n);
-	}
+		if (IsInline() || other.IsInline())
+		{
+			Array temp(mAllocator);
+			temp.takeStorage(other);
+			other.takeStorage(*this);
+			takeStorage(temp);
+			return;
+		}
 
-	ptrdiff_t operator-(const ArrayIterator& other) const noexcept
-	{
-		return mPtr - other.mPtr;
+		std::swap(mData, other.mData);
+		std::swap(mCount, other.mCount);
+		std::swap(mCapacity, other.mCapacity);
 	}
 
-	bool operator==(const ArrayIterator& other) const noexcept
+	// Takes other's elements, leaving it empty. This must be empty with no storage
+	// of its own, and both must share an allocator unless other is inline.
+	void takeStorage(Array& other) noexcept(NOTHROW_TAKE_STORAGE)
 	{
-		return mPtr == other.mPtr;
+		if (other.IsInline())
+		{
+			RelocateN(other.mData, other.mCount, mData);
+			mCount = std::exchange(other.mCount, 0);
+		}
+		else
+		{
+			mData = std::exchange(other.mData, other.mInline.Data());
+			mCount = std::exchange(other.mCount, 0);
+			mCapacity = std::exchange(other.mCapacity, InlineCapacity);
+		}
 	}
 
-	bool operator!=(const ArrayIterator& other) const noexcept
+	void cleanup() noexcept
 	{
-		return mPtr != other.mPtr;
+		if (mData)
+		{
+			std::destroy_n(mData, mCount);
+			deallocateStorage(mData, mCapacity);
+			mData = mInline.Data();
+			mCount = 0;
+			mCapacity = InlineCapacity;
+		}
 	}
 
 private:
-	T* mPtr;
+	[[no_unique_address]] Allocator mAllocator;
+	T* mData;
+	size_t mCount;
+	size_t mCapacity;
+	[[no_unique_address]] ArrayInlineStorage<T, InlineCapacity> mInline;
 };
 
 } // namespace abouttt
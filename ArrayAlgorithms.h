@@ -0,0 +1,425 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#include "Array.h"
+#include "ArrayView.h"
+#include "Memory.h"
+#include "ThreadPool.h"
+
+// Ranges shorter than this run the Parallel* algorithms serially. It is also the
+// smallest chunk handed to a worker thread.
+#ifndef ABOUTTT_ARRAY_PARALLEL_THRESHOLD
+#define ABOUTTT_ARRAY_PARALLEL_THRESHOLD (size_t(1) << 15)
+#endif
+
+namespace abouttt
+{
+
+// Algorithms over Arrays and ArrayViews that the containers themselves do not
+// need, kept here so that Array.h does not pull in threads. Each takes a view,
+// with an Array overload since a view's element type cannot be deduced through
+// the conversion.
+
+inline constexpr size_t PARALLEL_THRESHOLD = ABOUTTT_ARRAY_PARALLEL_THRESHOLD;
+
+// Number of chunks count elements are split into: at least PARALLEL_THRESHOLD
+// elements each, and a few per thread so that uneven chunks balance out.
+inline size_t ParallelChunkCount(size_t count, const ThreadPool& pool) noexcept
+{
+	return std::max<size_t>(std::min(count / PARALLEL_THRESHOLD, (pool.ThreadCount() + 1) * 4), 1);
+}
+
+// Calls fn on every element from several threads at once.
+template <typename T, typename Function>
+void ParallelForEach(ArrayView<T> view, Function fn, ThreadPool& pool = ThreadPool::Default())
+{
+	T* data = view.Data();
+	pool.ParallelFor(view.Count(), PARALLEL_THRESHOLD, [data, &fn](size_t begin, size_t end)
+	{
+		std::for_each(data + begin, data + end, fn);
+	});
+}
+
+template <typename T, typename Allocator, typename Growth, size_t N, typename Function>
+void ParallelForEach(Array<T, Allocator, Growth, N>& array, Function fn, ThreadPool& pool = ThreadPool::Default())
+{
+	ParallelForEach(array.View(), std::move(fn), pool);
+}
+
+// Folds the elements with op, which must be associative. Chunks are reduced in
+// parallel and their results combined in order, so the result matches the serial
+// fold op(op(init, a), b)... up to reassociation. U must be constructible from T.
+template <typename T, typename U, typename BinaryOp>
+U ParallelReduce(ArrayView<T> view, U init, BinaryOp op, ThreadPool& pool = ThreadPool::Default())
+{
+	const T* data = view.Data();
+	size_t count = view.Count();
+	size_t chunkCount = ParallelChunkCount(count, pool);
+	std::unique_ptr<std::optional<U>[]> partials = std::make_unique<std::optional<U>[]>(chunkCount);
+	pool.ParallelFor(chunkCount, 1, [&](size_t firstChunk, size_t lastChunk)
+	{
+		for (size_t chunk = firstChunk; chunk < lastChunk; ++chunk)
+		{
+			size_t begin = chunk * count / chunkCount;
+			size_t end = (chunk + 1) * count / chunkCount;
+			if (begin < end)
+			{
+				U partial(data[begin]);
+				for (size_t i = begin + 1; i < end; ++i)
+				{
+					partial = op(std::move(partial), data[i]);
+				}
+				partials[chunk].emplace(std::move(partial));
+			}
+		}
+	});
+
+	for (size_t chunk = 0; chunk < chunkCount; ++chunk)
+	{
+		if (partials[chunk])
+		{
+			init = op(std::move(init), std::move(*partials[chunk]));
+		}
+	}
+	return init;
+}
+
+template <typename T, typename Allocator, typename Growth, size_t N, typename U, typename BinaryOp>
+U ParallelReduce(const Array<T, Allocator, Growth, N>& array, U init, BinaryOp op, ThreadPool& pool = ThreadPool::Default())
+{
+	return ParallelReduce(array.View(), std::move(init), std::move(op), pool);
+}
+
+// Same result as array.RemoveAll(pred). The predicate runs in parallel and each
+// chunk is compacted in place; only the final gathering of survivors is serial.
+template <typename T, typename Allocator, typename Growth, size_t N, typename Predicate>
+size_t ParallelRemoveAll(Array<T, Allocator, Growth, N>& array, Predicate pred, ThreadPool& pool = ThreadPool::Default())
+{
+	T* data = array.Data();
+	size_t count = array.Count();
+	size_t chunkCount = ParallelChunkCount(count, pool);
+	if (chunkCount <= 1)
+	{
+		return array.RemoveAll(pred);
+	}
+
+	std::unique_ptr<size_t[]> kept = std::make_unique<size_t[]>(chunkCount);
+	pool.ParallelFor(chunkCount, 1, [&](size_t firstChunk, size_t lastChunk)
+	{
+		for (size_t chunk = firstChunk; chunk < lastChunk; ++chunk)
+		{
+			T* begin = data + chunk * count / chunkCount;
+			T* end = data + (chunk + 1) * count / chunkCount;
+			kept[chunk] = static_cast<size_t>(std::remove_if(begin, end, pred) - begin);
+		}
+	});
+
+	size_t newCount = kept[0];
+	for (size_t chunk = 1; chunk < chunkCount; ++chunk)
+	{
+		T* begin = data + chunk * count / chunkCount;
+		std::move(begin, begin + kept[chunk], data + newCount);
+		newCount += kept[chunk];
+	}
+
+	// The moved-from tail is last, so this only destroys it.
+	size_t removedCount = count - newCount;
+	array.RemoveAt(newCount, removedCount);
+	return removedCount;
+}
+
+// Number of elements of first that come before position k in the stable merge
+// of sorted first and second, of m and n elements. The rest of the k come from
+// second.
+template <typename T, typename Compare>
+size_t MergeCoRank(const T* first, size_t m, const T* second, size_t n, size_t k, Compare& comp)
+{
+	size_t low = k > n ? k - n : 0;
+	size_t high = std::min(k, m);
+	while (low < high)
+	{
+		size_t mid = low + (high - low) / 2;
+		if (comp(second[k - mid - 1], first[mid]))
+		{
+			high = mid;
+		}
+		else
+		{
+			low = mid + 1;
+		}
+	}
+	return low;
+}
+
+// Sorts chunks on separate threads, then merges them pairwise in rounds. Each
+// round is cut into equal pieces of output wherever the merges fall, with
+// MergeCoRank finding where each piece starts in its two runs, so the last
+// rounds are as parallel as the first. That needs a buffer of count elements;
+// types whose move may throw merge in place instead, one thread per pair. If
+// comp throws, the elements are left valid but unspecified.
+template <bool bStable, typename T, typename Compare>
+void ParallelMergeSort(ArrayView<T> view, Compare& comp, ThreadPool& pool)
+{
+	T* data = view.Data();
+	size_t count = view.Count();
+	size_t runCount = ParallelChunkCount(count, pool);
+	auto runBegin = [count, runCount](size_t run)
+	{
+		return std::min(run, runCount) * count / runCount;
+	};
+
+	pool.ParallelFor(runCount, 1, [&](size_t firstRun, size_t lastRun)
+	{
+		for (size_t run = firstRun; run < lastRun; ++run)
+		{
+			if constexpr (bStable)
+			{
+				std::stable_sort(data + runBegin(run), data + runBegin(run + 1), comp);
+			}
+			else
+			{
+				std::sort(data + runBegin(run), data + runBegin(run + 1), comp);
+			}
+		}
+	});
+
+	if (runCount <= 1)
+	{
+		return;
+	}
+
+	if constexpr (!std::is_nothrow_move_constructible_v<T>)
+	{
+		for (size_t width = 1; width < runCount; width *= 2)
+		{
+			size_t pairCount = (runCount + 2 * width - 1) / (2 * width);
+			pool.ParallelFor(pairCount, 1, [&](size_t firstPair, size_t lastPair)
+			{
+				for (size_t pair = firstPair; pair < lastPair; ++pair)
+				{
+					size_t run = pair * 2 * width;
+					if (run + width < runCount)
+					{
+						std::inplace_merge(data + runBegin(run), data + runBegin(run + width), data + runBegin(run + 2 * width), comp);
+					}
+				}
+			});
+		}
+	}
+	else
+	{
+		struct Buffer
+		{
+			~Buffer()
+			{
+				std::destroy_n(mData, mCount);
+				std::allocator<T>().deallocate(mData, mCapacity);
+			}
+
+			T* mData;
+			size_t mCount;
+			size_t mCapacity;
+		};
+
+		Buffer buffer{ std::allocator<T>().allocate(count), 0, count };
+		pool.ParallelFor(count, PARALLEL_THRESHOLD, [&](size_t begin, size_t end)
+		{
+			std::uninitialized_move(data + begin, data + end, buffer.mData + begin);
+		});
+		buffer.mCount = count;
+
+		T* source = buffer.mData;
+		T* dest = data;
+		size_t pieceCount = ParallelChunkCount(count, pool);
+		for (size_t width = 1; width < runCount; width *= 2)
+		{
+			pool.ParallelFor(pieceCount, 1, [&](size_t firstPiece, size_t lastPiece)
+			{
+				size_t outBegin = firstPiece * count / pieceCount;
+				size_t outEnd = lastPiece * count / pieceCount;
+				for (size_t run = 0; run < runCount; run += 2 * width)
+				{
+					size_t first = runBegin(run);
+					size_t middle = runBegin(run + width);
+					size_t last = runBegin(run + 2 * width);
+					if (last <= outBegin || first >= outEnd)
+					{
+						continue;
+					}
+
+					const T* left = source + first;
+					const T* right = source + middle;
+					size_t leftCount = middle - first;
+					size_t rightCount = last - middle;
+					size_t begin = std::max(outBegin, first) - first;
+					size_t end = std::min(outEnd, last) - first;
+					size_t leftBegin = MergeCoRank(left, leftCount, right, rightCount, begin, comp);
+					size_t leftEnd = MergeCoRank(left, leftCount, right, rightCount, end, comp);
+					std::merge(
+						std::make_move_iterator(source + first + leftBegin), std::make_move_iterator(source + first + leftEnd),
+						std::make_move_iterator(source + middle + begin - leftBegin), std::make_move_iterator(source + middle + end - leftEnd),
+						dest + first + begin, comp);
+				}
+			});
+			std::swap(source, dest);
+		}
+
+		if (source != data)
+		{
+			pool.ParallelFor(count, PARALLEL_THRESHOLD, [&](size_t begin, size_t end)
+			{
+				std::move(source + begin, source + end, data + begin);
+			});
+		}
+	}
+}
+
+template <typename T, typename Compare>
+void ParallelSort(ArrayView<T> view, Compare comp, ThreadPool& pool = ThreadPool::Default())
+{
+	ParallelMergeSort<false>(view, comp, pool);
+}
+
+template <typename T, typename Allocator, typename Growth, size_t N, typename Compare>
+void ParallelSort(Array<T, Allocator, Growth, N>& array, Compare comp, ThreadPool& pool = ThreadPool::Default())
+{
+	ParallelMergeSort<false>(array.View(), comp, pool);
+}
+
+template <typename T, typename Compare>
+void ParallelStableSort(ArrayView<T> view, Compare comp, ThreadPool& pool = ThreadPool::Default())
+{
+	ParallelMergeSort<true>(view, comp, pool);
+}
+
+template <typename T, typename Allocator, typename Growth, size_t N, typename Compare>
+void ParallelStableSort(Array<T, Allocator, Growth, N>& array, Compare comp, ThreadPool& pool = ThreadPool::Default())
+{
+	ParallelMergeSort<true>(array.View(), comp, pool);
+}
+
+// Replaces every element with fn(element), from several threads at once.
+template <typename T, typename Function>
+void ParallelTransform(ArrayView<T> view, Function fn, ThreadPool& pool = ThreadPool::Default())
+{
+	T* data = view.Data();
+	pool.ParallelFor(view.Count(), PARALLEL_THRESHOLD, [data, &fn](size_t begin, size_t end)
+	{
+		std::transform(data + begin, data + end, data + begin, fn);
+	});
+}
+
+template <typename T, typename Allocator, typename Growth, size_t N, typename Function>
+void ParallelTransform(Array<T, Allocator, Growth, N>& array, Function fn, ThreadPool& pool = ThreadPool::Default())
+{
+	ParallelTransform(array.View(), std::move(fn), pool);
+}
+
+// Stable LSD radix sort on the integral key returned by keyFn, one byte per pass.
+// Passes in which every key has the same byte are skipped. The scratch buffers,
+// one for the elements and one for twice as many keys, come from alloc.
+template <typename T, typename KeyFunction, typename Allocator = std::allocator<T>>
+void SortByKey(ArrayView<T> view, KeyFunction keyFn, const Allocator& alloc = Allocator())
+{
+	using Key = std::remove_cvref_t<std::invoke_result_t<KeyFunction&, const T&>>;
+	using AllocatorTraits = std::allocator_traits<Allocator>;
+	static_assert(std::is_integral_v<Key> && !std::is_same_v<Key, bool>, "SortByKey requires an integral, non-bool key");
+	static_assert(std::is_nothrow_move_constructible_v<T>, "SortByKey requires T to be nothrow move constructible");
+
+	using RadixKey = std::make_unsigned_t<Key>;
+	auto radixKey = [&keyFn](const T& value)
+	{
+		RadixKey key = static_cast<RadixKey>(keyFn(value));
+		if constexpr (std::is_signed_v<Key>)
+		{
+			key ^= RadixKey(1) << (std::numeric_limits<RadixKey>::digits - 1);
+		}
+		return key;
+	};
+
+	T* data = view.Data();
+	size_t count = view.Count();
+	if (count < 256)
+	{
+		std::stable_sort(data, data + count, [&radixKey](const T& a, const T& b)
+		{
+			return radixKey(a) < radixKey(b);
+		});
+		return;
+	}
+
+	// Keys are computed once, before anything moves, so that a throwing keyFn
+	// leaves the elements in place. Each pass then carries them along with their
+	// elements.
+	using KeyAllocator = typename AllocatorTraits::template rebind_alloc<RadixKey>;
+	Array<RadixKey, KeyAllocator> keyBuffer(2 * count, KeyAllocator(alloc));
+	keyBuffer.ResizeUninitialized(2 * count);
+	RadixKey* sourceKeys = keyBuffer.Data();
+	RadixKey* destKeys = sourceKeys + count;
+
+	constexpr size_t passCount = sizeof(Key);
+	size_t counts[passCount][256] = {};
+	for (size_t i = 0; i < count; ++i)
+	{
+		RadixKey key = radixKey(data[i]);
+		sourceKeys[i] = key;
+		for (size_t pass = 0; pass < passCount; ++pass)
+		{
+			++counts[pass][(key >> (pass * 8)) & 0xFF];
+		}
+	}
+
+	Allocator allocator(alloc);
+	T* scratch = AllocatorTraits::allocate(allocator, count);
+	T* source = data;
+	T* dest = scratch;
+	for (size_t pass = 0; pass < passCount; ++pass)
+	{
+		size_t* passCounts = counts[pass];
+		size_t firstDigit = (sourceKeys[0] >> (pass * 8)) & 0xFF;
+		if (passCounts[firstDigit] == count)
+		{
+			continue;
+		}
+
+		size_t offset = 0;
+		for (size_t digit = 0; digit < 256; ++digit)
+		{
+			size_t digitCount = passCounts[digit];
+			passCounts[digit] = offset;
+			offset += digitCount;
+		}
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			size_t digit = (sourceKeys[i] >> (pass * 8)) & 0xFF;
+			size_t target = passCounts[digit]++;
+			RelocateN(source + i, 1, dest + target);
+			destKeys[target] = sourceKeys[i];
+		}
+		std::swap(source, dest);
+		std::swap(sourceKeys, destKeys);
+	}
+
+	if (source != data)
+	{
+		RelocateN(source, count, data);
+	}
+	AllocatorTraits::deallocate(allocator, scratch, count);
+}
+
+template <typename T, typename Allocator, typename Growth, size_t N, typename KeyFunction>
+void SortByKey(Array<T, Allocator, Growth, N>& array, KeyFunction keyFn)
+{
+	SortByKey(array.View(), std::move(keyFn), array.GetAllocator());
+}
+
+} // namespace abouttt
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <compare>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+
+namespace abouttt
+{
+
+template <typename T>
+class ArrayIterator
+{
+public:
+	template <typename>
+	friend class ArrayIterator;
+
+public:
+	using iterator_concept = std::contiguous_iterator_tag;
+	using iterator_category = std::random_access_iterator_tag;
+	using value_type = std::remove_cv_t<T>;
+	using element_type = T;
+	using difference_type = ptrdiff_t;
+	using pointer = T*;
+	using reference = T&;
+
+public:
+	ArrayIterator() noexcept
+		: mPtr(nullptr)
+	{
+	}
+
+	explicit ArrayIterator(T* ptr) noexcept
+		: mPtr(ptr)
+	{
+	}
+
+	template<typename U = T, typename = std::enable_if_t<std::is_const_v<U>>>
+	ArrayIterator(const ArrayIterator<std::remove_const_t<T>>& other) noexcept
+		: mPtr(other.mPtr)
+	{
+	}
+
+public:
+	T& operator*() const noexcept
+	{
+		return *mPtr;
+	}
+
+	T* operator->() const noexcept
+	{
+		return mPtr;
+	}
+
+	T& operator[](ptrdiff_t index) const noexcept
+	{
+		return *(mPtr + index);
+	}
+
+	ArrayIterator& operator++() noexcept
+	{
+		++mPtr;
+		return *this;
+	}
+
+	ArrayIterator operator++(int) noexcept
+	{
+		ArrayIterator temp = *this;
+		++mPtr;
+		return temp;
+	}
+
+	ArrayIterator& operator--() noexcept
+	{
+		--mPtr;
+		return *this;
+	}
+
+	ArrayIterator operator--(int) noexcept
+	{
+		ArrayIterator temp = *this;
+		--mPtr;
+		return temp;
+	}
+
+	ArrayIterator& operator+=(ptrdiff_t n) noexcept
+	{
+		mPtr += n;
+		return *this;
+	}
+
+	ArrayIterator& operator-=(ptrdiff_t n) noexcept
+	{
+		mPtr -= n;
+		return *this;
+	}
+
+	ArrayIterator operator+(ptrdiff_t n) const noexcept
+	{
+		return ArrayIterator(mPtr + n);
+	}
+
+	friend ArrayIterator operator+(ptrdiff_t n, const ArrayIterator& it) noexcept
+	{
+		return ArrayIterator(it.mPtr + n);
+	}
+
+	ArrayIterator operator-(ptrdiff_t n) const noexcept
+	{
+		return ArrayIterator(mPtr - n);
+	}
+
+	ptrdiff_t operator-(const ArrayIterator& other) const noexcept
+	{
+		return mPtr - other.mPtr;
+	}
+
+	bool operator==(const ArrayIterator& other) const noexcept
+	{
+		return mPtr == other.mPtr;
+	}
+
+	bool operator!=(const ArrayIterator& other) const noexcept
+	{
+		return mPtr != other.mPtr;
+	}
+
+	auto operator<=>(const ArrayIterator& other) const noexcept
+	{
+		return mPtr <=> other.mPtr;
+	}
+
+private:
+	T* mPtr;
+};
+
+// Iteration is plain pointer arithmetic with no bounds checks.
+static_assert(std::contiguous_iterator<ArrayIterator<int>>);
+static_assert(std::contiguous_iterator<ArrayIterator<const int>>);
+
+} // namespace abouttt
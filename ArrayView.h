@@ -0,0 +1,199 @@
+#pragma once
+
+#include <algorithm>
+#include <compare>
+#include <cstddef>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+
+#include "ArrayIterator.h"
+#include "Simd.h"
+
+// operator[] checks its index only when this is non-zero; At() always checks.
+#ifndef ABOUTTT_ARRAY_BOUNDS_CHECK
+#ifdef NDEBUG
+#define ABOUTTT_ARRAY_BOUNDS_CHECK 0
+#else
+#define ABOUTTT_ARRAY_BOUNDS_CHECK 1
+#endif
+#endif
+
+namespace abouttt
+{
+
+// Non-owning view of count contiguous elements, two words passed by value. T may
+// be const for a read-only view, and a view of T converts to a view of const T.
+// A view never outlives the storage it was taken from: anything that reallocates
+// or destroys the owner, such as growing an Array, leaves it dangling.
+template <typename T>
+class ArrayView
+{
+public:
+	template <typename>
+	friend class ArrayView;
+
+public:
+	using ValueType = std::remove_cv_t<T>;
+	using Iterator = ArrayIterator<T>;
+	using ReverseIterator = std::reverse_iterator<Iterator>;
+
+public:
+	static constexpr size_t INDEX_NONE = std::numeric_limits<size_t>::max();
+
+public:
+	ArrayView() noexcept
+		: mData(nullptr)
+		, mCount(0)
+	{
+	}
+
+	ArrayView(T* data, size_t count) noexcept
+		: mData(data)
+		, mCount(count)
+	{
+	}
+
+	ArrayView(Iterator first, Iterator last) noexcept
+		: mData(std::to_address(first))
+		, mCount(static_cast<size_t>(last - first))
+	{
+	}
+
+	template <typename U, typename = std::enable_if_t<std::is_convertible_v<U (*)[], T (*)[]>>>
+	ArrayView(const ArrayView<U>& other) noexcept
+		: mData(other.mData)
+		, mCount(other.mCount)
+	{
+	}
+
+public:
+	T& operator[](size_t index) const noexcept(!ABOUTTT_ARRAY_BOUNDS_CHECK)
+	{
+#if ABOUTTT_ARRAY_BOUNDS_CHECK
+		checkRange(index);
+#endif
+		return mData[index];
+	}
+
+	auto operator<=>(const ArrayView& other) const
+	{
+		return std::lexicographical_compare_three_way(
+			mData, mData + mCount,
+			other.mData, other.mData + other.mCount
+		);
+	}
+
+	bool operator==(const ArrayView& other) const
+	{
+		return mCount == other.mCount && std::equal(mData, mData + mCount, other.mData);
+	}
+
+public:
+	T& At(size_t index) const
+	{
+		checkRange(index);
+		return mData[index];
+	}
+
+	bool Contains(const ValueType& value) const
+	{
+		return Find(value) != INDEX_NONE;
+	}
+
+	template <typename Predicate>
+	bool ContainsIf(Predicate pred) const
+	{
+		return FindIf(pred) != INDEX_NONE;
+	}
+
+	size_t Count() const noexcept
+	{
+		return mCount;
+	}
+
+	T* Data() const noexcept
+	{
+		return mData;
+	}
+
+	size_t Find(const ValueType& value) const
+	{
+		if constexpr (IsSimdSearchableV<ValueType>)
+		{
+			size_t index = SimdSearch::Find(static_cast<const ValueType*>(mData), mCount, value);
+			return index != mCount ? index : INDEX_NONE;
+		}
+		else
+		{
+			T* it = std::find(mData, mData + mCount, value);
+			return it != mData + mCount ? static_cast<size_t>(it - mData) : INDEX_NONE;
+		}
+	}
+
+	template <typename Predicate>
+	size_t FindIf(Predicate pred) const
+	{
+		T* it = std::find_if(mData, mData + mCount, pred);
+		return it != mData + mCount ? static_cast<size_t>(it - mData) : INDEX_NONE;
+	}
+
+	bool IsEmpty() const noexcept
+	{
+		return mCount == 0;
+	}
+
+	// The count elements starting at offset, which must lie within this view.
+	ArrayView Slice(size_t offset, size_t count) const
+	{
+		if (offset > mCount || count > mCount - offset)
+		{
+			throw std::out_of_range("ArrayView slice out of range");
+		}
+		return ArrayView(mData + offset, count);
+	}
+
+	// The elements from offset to the end.
+	ArrayView Slice(size_t offset) const
+	{
+		return Slice(offset, offset <= mCount ? mCount - offset : 0);
+	}
+
+public: // Iterators for range-based loop support.
+	Iterator begin() const noexcept
+	{
+		return Iterator(mData);
+	}
+
+	Iterator end() const noexcept
+	{
+		return Iterator(mData + mCount);
+	}
+
+	ReverseIterator rbegin() const noexcept
+	{
+		return ReverseIterator(end());
+	}
+
+	ReverseIterator rend() const noexcept
+	{
+		return ReverseIterator(begin());
+	}
+
+private:
+	void checkRange(size_t index) const
+	{
+		if (index >= mCount)
+		{
+			throw std::out_of_range("ArrayView index out of range");
+		}
+	}
+
+private:
+	T* mData;
+	size_t mCount;
+};
+
+} // namespace abouttt
@@ -0,0 +1,568 @@
+#pragma once
+
+#include <algorithm>
+#include <compare>
+#include <cstddef>
+#include <initializer_list>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "Instrumentation.h"
+#include "Simd.h"
+
+namespace abouttt
+{
+
+// Fills a block, link included, to about one page.
+template <typename T>
+inline constexpr size_t DEFAULT_CHUNKED_QUEUE_BLOCK_SIZE = std::max<size_t>(16, (4096 - sizeof(void*)) / sizeof(T));
+
+// FIFO queue stored in a chain of fixed-size blocks. Growing links one more block
+// at the rear and never moves an element, and a block emptied at the front goes to
+// a cache of up to MaxFreeBlocks idle blocks for reuse, so Enqueue, Dequeue and
+// Peek are O(1) in the worst case, not just amortized. The price over Queue is
+// one pointer chase per BlockSize elements.
+template <typename T, typename Allocator = std::allocator<T>, size_t BlockSize = DEFAULT_CHUNKED_QUEUE_BLOCK_SIZE<T>, size_t MaxFreeBlocks = 2>
+class ChunkedQueue
+{
+	static_assert(std::is_same_v<typename Allocator::value_type, T>, "Allocator::value_type must be T");
+	static_assert(BlockSize > 0, "BlockSize must be positive");
+
+private:
+	struct Block
+	{
+		Block* mNext;
+		alignas(T) std::byte mStorage[sizeof(T) * BlockSize];
+
+		// Leaves the storage uninitialized.
+		Block() noexcept
+			: mNext(nullptr)
+		{
+		}
+
+		T* data() noexcept
+		{
+			return std::launder(reinterpret_cast<T*>(mStorage));
+		}
+
+		const T* data() const noexcept
+		{
+			return std::launder(reinterpret_cast<const T*>(mStorage));
+		}
+	};
+
+	using BlockAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Block>;
+	using BlockAllocatorTraits = std::allocator_traits<BlockAllocator>;
+
+public:
+	using AllocatorType = Allocator;
+
+public:
+	static constexpr size_t BLOCK_SIZE = BlockSize;
+	static constexpr size_t MAX_FREE_BLOCKS = MaxFreeBlocks;
+
+public:
+	ChunkedQueue() noexcept
+		: ChunkedQueue(Allocator())
+	{
+	}
+
+	explicit ChunkedQueue(const Allocator& alloc) noexcept
+		: mAllocator(alloc)
+		, mFrontBlock(nullptr)
+		, mRearBlock(nullptr)
+		, mFreeBlocks(nullptr)
+		, mFront(0)
+		, mRear(0)
+		, mCount(0)
+		, mFreeCount(0)
+	{
+	}
+
+	explicit ChunkedQueue(size_t capacity, const Allocator& alloc = Allocator())
+		: ChunkedQueue(alloc)
+	{
+		Reserve(capacity);
+	}
+
+	ChunkedQueue(std::initializer_list<T> ilist, const Allocator& alloc = Allocator())
+		: ChunkedQueue(alloc)
+	{
+		for (const T& value : ilist)
+		{
+			Enqueue(value);
+		}
+	}
+
+	ChunkedQueue(const ChunkedQueue& other)
+		: ChunkedQueue(other, Allocator(BlockAllocatorTraits::select_on_container_copy_construction(other.mAllocator)))
+	{
+	}
+
+	ChunkedQueue(const ChunkedQueue& other, const Allocator& alloc)
+		: ChunkedQueue(alloc)
+	{
+		other.forEach([this](const T& value) { Enqueue(value); });
+	}
+
+	ChunkedQueue(ChunkedQueue&& other) noexcept
+		: mAllocator(std::move(other.mAllocator))
+		, mFrontBlock(std::exchange(other.mFrontBlock, nullptr))
+		, mRearBlock(std::exchange(other.mRearBlock, nullptr))
+		, mFreeBlocks(std::exchange(other.mFreeBlocks, nullptr))
+		, mFront(std::exchange(other.mFront, 0))
+		, mRear(std::exchange(other.mRear, 0))
+		, mCount(std::exchange(other.mCount, 0))
+		, mFreeCount(std::exchange(other.mFreeCount, 0))
+	{
+	}
+
+	ChunkedQueue(ChunkedQueue&& other, const Allocator& alloc)
+		: ChunkedQueue(alloc)
+	{
+		if (mAllocator == other.mAllocator)
+		{
+			swapStorage(other);
+		}
+		else
+		{
+			other.forEach([this](T& value) { Enqueue(std::move(value)); });
+			other.Clear();
+		}
+	}
+
+	~ChunkedQueue()
+	{
+		cleanup();
+	}
+
+public:
+	ChunkedQueue& operator=(const ChunkedQueue& other)
+	{
+		if (this != &other)
+		{
+			if constexpr (BlockAllocatorTraits::propagate_on_container_copy_assignment::value)
+			{
+				if (mAllocator != other.mAllocator)
+				{
+					cleanup();
+				}
+				mAllocator = other.mAllocator;
+			}
+			ChunkedQueue temp(other, GetAllocator());
+			swapStorage(temp);
+		}
+		return *this;
+	}
+
+	ChunkedQueue& operator=(ChunkedQueue&& other) noexcept(
+		BlockAllocatorTraits::propagate_on_container_move_assignment::value ||
+		BlockAllocatorTraits::is_always_equal::value)
+	{
+		if (this != &other)
+		{
+			if constexpr (BlockAllocatorTraits::propagate_on_container_move_assignment::value)
+			{
+				cleanup();
+				mAllocator = std::move(other.mAllocator);
+				swapStorage(other);
+			}
+			else
+			{
+				ChunkedQueue temp(std::move(other), GetAllocator());
+				swapStorage(temp);
+			}
+		}
+		return *this;
+	}
+
+	ChunkedQueue& operator=(std::initializer_list<T> ilist)
+	{
+		ChunkedQueue temp(ilist, GetAllocator());
+		swapStorage(temp);
+		return *this;
+	}
+
+	auto operator<=>(const ChunkedQueue& other) const
+	{
+		const Block* a = mFrontBlock;
+		const Block* b = other.mFrontBlock;
+		size_t i = mFront;
+		size_t j = other.mFront;
+		for (size_t n = std::min(mCount, other.mCount); n > 0; --n)
+		{
+			if (auto cmp = a->data()[i] <=> b->data()[j]; cmp != 0)
+			{
+				return cmp;
+			}
+			step(a, i);
+			step(b, j);
+		}
+
+		return mCount <=> other.mCount;
+	}
+
+	bool operator==(const ChunkedQueue& other) const
+	{
+		if (mCount != other.mCount)
+		{
+			return false;
+		}
+
+		const Block* a = mFrontBlock;
+		const Block* b = other.mFrontBlock;
+		size_t i = mFront;
+		size_t j = other.mFront;
+		for (size_t n = mCount; n > 0; --n)
+		{
+			if (a->data()[i] != b->data()[j])
+			{
+				return false;
+			}
+			step(a, i);
+			step(b, j);
+		}
+
+		return true;
+	}
+
+public:
+	// Elements that fit before another block has to be allocated.
+	size_t Capacity() const noexcept
+	{
+		return mCount + (mRearBlock ? BlockSize - mRear : 0) + mFreeCount * BlockSize;
+	}
+
+	// Returns every block to the free cache, releasing those that do not fit.
+	void Clear() noexcept
+	{
+		forEach([](T& value) { std::destroy_at(&value); });
+		while (mFrontBlock)
+		{
+			Block* next = mFrontBlock->mNext;
+			releaseBlock(mFrontBlock);
+			mFrontBlock = next;
+		}
+		mRearBlock = nullptr;
+		mFront = 0;
+		mRear = 0;
+		mCount = 0;
+	}
+
+	bool Contains(const T& value) const
+	{
+		for (const Block* block = mFrontBlock; block != nullptr; block = block->mNext)
+		{
+			const T* first = block->data() + (block == mFrontBlock ? mFront : 0);
+			size_t count = block->data() + (block == mRearBlock ? mRear : BlockSize) - first;
+			if constexpr (IsSimdSearchableV<T>)
+			{
+				if (SimdSearch::Find(first, count, value) != count)
+				{
+					return true;
+				}
+			}
+			else
+			{
+				if (std::find(first, first + count, value) != first + count)
+				{
+					return true;
+				}
+			}
+		}
+		return false;
+	}
+
+	size_t Count() const noexcept
+	{
+		return mCount;
+	}
+
+	void Dequeue()
+	{
+		checkEmpty();
+		std::destroy_at(mFrontBlock->data() + mFront);
+		advanceFront();
+	}
+
+	template <typename... Args>
+	void Emplace(Args&&... args)
+	{
+		if (!mRearBlock || mRear == BlockSize)
+		{
+			linkBlock();
+		}
+		std::construct_at(mRearBlock->data() + mRear, std::forward<Args>(args)...);
+		++mRear;
+		++mCount;
+	}
+
+	void Enqueue(const T& value)
+	{
+		Emplace(value);
+	}
+
+	void Enqueue(T&& value)
+	{
+		Emplace(std::move(value));
+	}
+
+	Allocator GetAllocator() const noexcept
+	{
+		return Allocator(mAllocator);
+	}
+
+	bool IsEmpty() const noexcept
+	{
+		return mCount == 0;
+	}
+
+	T& Peek()
+	{
+		checkEmpty();
+		return mFrontBlock->data()[mFront];
+	}
+
+	const T& Peek() const
+	{
+		checkEmpty();
+		return mFrontBlock->data()[mFront];
+	}
+
+	T Pop()
+	{
+		checkEmpty();
+		return popFront();
+	}
+
+	// Pops up to count elements, front first, into out and returns how many were popped.
+	template <typename OutputIt>
+	size_t PopN(size_t count, OutputIt out)
+	{
+		size_t popped = std::min(count, mCount);
+		for (size_t i = 0; i < popped; ++i)
+		{
+			*out = popFront();
+			++out;
+		}
+		return popped;
+	}
+
+	// Allocates free blocks up front, past MaxFreeBlocks if need be, so that the
+	// next newCapacity - Count() enqueues do not allocate.
+	void Reserve(size_t newCapacity)
+	{
+		// Chains the new blocks in allocation order, which is the order they are used in.
+		Block** link = &mFreeBlocks;
+		while (*link)
+		{
+			link = &(*link)->mNext;
+		}
+		while (Capacity() < newCapacity)
+		{
+			*link = createBlock();
+			link = &(*link)->mNext;
+			++mFreeCount;
+		}
+	}
+
+	// Releases the free cache, and the last block too when the queue is empty.
+	void Shrink() noexcept
+	{
+		if (mCount == 0)
+		{
+			Clear();
+		}
+		while (mFreeBlocks)
+		{
+			Block* next = mFreeBlocks->mNext;
+			destroyBlock(mFreeBlocks);
+			mFreeBlocks = next;
+		}
+		mFreeCount = 0;
+	}
+
+	void Swap(ChunkedQueue& other) noexcept
+	{
+		if constexpr (BlockAllocatorTraits::propagate_on_container_swap::value)
+		{
+			std::swap(mAllocator, other.mAllocator);
+		}
+		swapStorage(other);
+	}
+
+	bool TryPop(T& outValue)
+	{
+		if (mCount == 0)
+		{
+			return false;
+		}
+		outValue = popFront();
+		return true;
+	}
+
+private:
+	void checkEmpty() const
+	{
+		if (mCount == 0)
+		{
+			throw std::out_of_range("Queue is empty");
+		}
+	}
+
+	// Moves past the front slot once its element is gone, handing the front block
+	// back when it runs out. A lone block that runs out is empty and is rewound.
+	void advanceFront() noexcept
+	{
+		--mCount;
+		if (++mFront == BlockSize)
+		{
+			if (mFrontBlock != mRearBlock)
+			{
+				Block* block = mFrontBlock;
+				mFrontBlock = block->mNext;
+				releaseBlock(block);
+			}
+			else
+			{
+				mRear = 0;
+			}
+			mFront = 0;
+		}
+	}
+
+	T popFront()
+	{
+		T value = std::move(mFrontBlock->data()[mFront]);
+		std::destroy_at(mFrontBlock->data() + mFront);
+		advanceFront();
+		return value;
+	}
+
+	// Appends an empty block, from the free cache when possible. If the element
+	// then fails to construct, the block simply stays linked for the next attempt.
+	void linkBlock()
+	{
+		Block* block = mFreeBlocks;
+		if (block)
+		{
+			mFreeBlocks = block->mNext;
+			block->mNext = nullptr;
+			--mFreeCount;
+		}
+		else
+		{
+			block = createBlock();
+		}
+
+		if (mRearBlock)
+		{
+			mRearBlock->mNext = block;
+		}
+		else
+		{
+			mFrontBlock = block;
+			mFront = 0;
+		}
+		mRearBlock = block;
+		mRear = 0;
+	}
+
+	Block* createBlock()
+	{
+		Block* block = BlockAllocatorTraits::allocate(mAllocator, 1);
+		std::construct_at(block);
+		ABOUTTT_INSTRUMENT(NodeAllocate, "ChunkedQueue", this, sizeof(Block), 1);
+		return block;
+	}
+
+	void destroyBlock(Block* block) noexcept
+	{
+		std::destroy_at(block);
+		BlockAllocatorTraits::deallocate(mAllocator, block, 1);
+		ABOUTTT_INSTRUMENT(NodeFree, "ChunkedQueue", this, sizeof(Block), 1);
+	}
+
+	void releaseBlock(Block* block) noexcept
+	{
+		if (mFreeCount < MaxFreeBlocks)
+		{
+			block->mNext = mFreeBlocks;
+			mFreeBlocks = block;
+			++mFreeCount;
+		}
+		else
+		{
+			destroyBlock(block);
+		}
+	}
+
+	// Moves a position within the chain to the next element.
+	template <typename B>
+	static void step(B*& block, size_t& index) noexcept
+	{
+		if (++index == BlockSize)
+		{
+			block = block->mNext;
+			index = 0;
+		}
+	}
+
+	// Calls fn on every element, front first.
+	template <typename Function>
+	void forEach(Function fn)
+	{
+		Block* block = mFrontBlock;
+		size_t index = mFront;
+		for (size_t n = mCount; n > 0; --n)
+		{
+			fn(block->data()[index]);
+			step(block, index);
+		}
+	}
+
+	template <typename Function>
+	void forEach(Function fn) const
+	{
+		const Block* block = mFrontBlock;
+		size_t index = mFront;
+		for (size_t n = mCount; n > 0; --n)
+		{
+			fn(block->data()[index]);
+			step(block, index);
+		}
+	}
+
+	void swapStorage(ChunkedQueue& other) noexcept
+	{
+		std::swap(mFrontBlock, other.mFrontBlock);
+		std::swap(mRearBlock, other.mRearBlock);
+		std::swap(mFreeBlocks, other.mFreeBlocks);
+		std::swap(mFront, other.mFront);
+		std::swap(mRear, other.mRear);
+		std::swap(mCount, other.mCount);
+		std::swap(mFreeCount, other.mFreeCount);
+	}
+
+	void cleanup() noexcept
+	{
+		Clear();
+		Shrink();
+	}
+
+private:
+	[[no_unique_address]] BlockAllocator mAllocator;
+	Block* mFrontBlock;
+	Block* mRearBlock;
+	// Singly linked through Block::mNext.
+	Block* mFreeBlocks;
+	size_t mFront;
+	size_t mRear;
+	size_t mCount;
+	size_t mFreeCount;
+};
+
+} // namespace abouttt
@@ -0,0 +1,238 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include "Memory.h"
+#include "PriorityQueue.h"
+#include "SpinWait.h"
+
+namespace abouttt
+{
+
+// Relaxed concurrent priority queue (MultiQueue). Elements are spread over
+// independent PriorityQueue shards, each behind its own try-lock; a pop locks the
+// better of two randomly chosen shards. Threads rarely contend, but a pop may
+// return an element that is not the global top: the expected rank error grows
+// linearly with the shard count, which is therefore the relaxation knob. A few
+// shards per thread is the usual choice.
+template <typename T, typename Compare = std::less<T>, typename Allocator = std::allocator<T>, size_t Arity = 2>
+class ConcurrentPriorityQueue
+{
+	static_assert(std::is_same_v<typename Allocator::value_type, T>, "Allocator::value_type must be T");
+
+private:
+	struct alignas(CACHE_LINE_SIZE) Shard
+	{
+		Shard(const Compare& comp, const Allocator& alloc)
+			: mQueue(comp, alloc)
+			, mCount(0)
+		{
+		}
+
+		SpinLock mLock;
+		PriorityQueue<T, Compare, Allocator, Arity> mQueue;
+		// Mirrors mQueue.Count() so that empty shards can be skipped without locking.
+		std::atomic<size_t> mCount;
+	};
+
+	using ShardAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Shard>;
+	using ShardAllocatorTraits = std::allocator_traits<ShardAllocator>;
+
+public:
+	using AllocatorType = Allocator;
+
+public:
+	static constexpr size_t DEFAULT_SHARDS_PER_THREAD = 2;
+
+public:
+	ConcurrentPriorityQueue()
+		: ConcurrentPriorityQueue(DEFAULT_SHARDS_PER_THREAD * std::max(1u, std::thread::hardware_concurrency()))
+	{
+	}
+
+	explicit ConcurrentPriorityQueue(size_t shardCount, const Compare& comp = Compare(), const Allocator& alloc = Allocator())
+		: mCompare(comp)
+		, mAllocator(alloc)
+		, mShardCount(std::max<size_t>(shardCount, 1))
+		, mShards(ShardAllocatorTraits::allocate(mAllocator, mShardCount))
+	{
+		for (size_t i = 0; i < mShardCount; ++i)
+		{
+			std::construct_at(mShards + i, comp, alloc);
+		}
+	}
+
+	ConcurrentPriorityQueue(const ConcurrentPriorityQueue&) = delete;
+
+	~ConcurrentPriorityQueue()
+	{
+		std::destroy_n(mShards, mShardCount);
+		ShardAllocatorTraits::deallocate(mAllocator, mShards, mShardCount);
+	}
+
+public:
+	ConcurrentPriorityQueue& operator=(const ConcurrentPriorityQueue&) = delete;
+
+public:
+	// Approximate while other threads are operating on the queue.
+	size_t Count() const noexcept
+	{
+		size_t count = 0;
+		for (size_t i = 0; i < mShardCount; ++i)
+		{
+			count += mShards[i].mCount.load(std::memory_order_relaxed);
+		}
+		return count;
+	}
+
+	template <typename... Args>
+	void Emplace(Args&&... args)
+	{
+		Shard& shard = lockRandomShard();
+		try
+		{
+			shard.mQueue.Emplace(std::forward<Args>(args)...);
+		}
+		catch (...)
+		{
+			unlock(shard);
+			throw;
+		}
+		unlock(shard);
+	}
+
+	void Enqueue(const T& value)
+	{
+		Emplace(value);
+	}
+
+	void Enqueue(T&& value)
+	{
+		Emplace(std::move(value));
+	}
+
+	// Inserts the whole range into a single shard under one lock acquisition, using
+	// PriorityQueue::EnqueueRange to heapify in bulk.
+	template <std::input_iterator InputIt>
+	void EnqueueRange(InputIt first, InputIt last)
+	{
+		Shard& shard = lockRandomShard();
+		try
+		{
+			shard.mQueue.EnqueueRange(first, last);
+		}
+		catch (...)
+		{
+			unlock(shard);
+			throw;
+		}
+		unlock(shard);
+	}
+
+	bool IsEmpty() const noexcept
+	{
+		return Count() == 0;
+	}
+
+	size_t ShardCount() const noexcept
+	{
+		return mShardCount;
+	}
+
+	// Moves out a high-priority element, not necessarily the highest. Returns false
+	// once every shard is observed empty.
+	bool TryPop(T& outValue)
+	{
+		for (;;)
+		{
+			for (size_t attempt = 0; attempt < mShardCount; ++attempt)
+			{
+				if (tryPopBestOfTwo(outValue))
+				{
+					return true;
+				}
+				CpuRelax();
+			}
+
+			if (IsEmpty())
+			{
+				return false;
+			}
+		}
+	}
+
+private:
+	Shard& lockRandomShard() noexcept
+	{
+		for (;;)
+		{
+			Shard& shard = mShards[nextRandom() % mShardCount];
+			if (shard.mLock.TryLock())
+			{
+				return shard;
+			}
+			CpuRelax();
+		}
+	}
+
+	bool tryPopBestOfTwo(T& outValue)
+	{
+		Shard* best = &mShards[nextRandom() % mShardCount];
+		Shard* other = &mShards[nextRandom() % mShardCount];
+		if (best->mCount.load(std::memory_order_relaxed) == 0)
+		{
+			std::swap(best, other);
+		}
+		if (best->mCount.load(std::memory_order_relaxed) == 0 || !best->mLock.TryLock())
+		{
+			return false;
+		}
+
+		if (other != best && other->mCount.load(std::memory_order_relaxed) > 0 && other->mLock.TryLock())
+		{
+			if (best->mQueue.IsEmpty() ||
+				(!other->mQueue.IsEmpty() && mCompare(best->mQueue.Peek(), other->mQueue.Peek())))
+			{
+				std::swap(best, other);
+			}
+			unlock(*other);
+		}
+
+		bool bPopped = best->mQueue.TryPop(outValue);
+		unlock(*best);
+		return bPopped;
+	}
+
+	static void unlock(Shard& shard) noexcept
+	{
+		shard.mCount.store(shard.mQueue.Count(), std::memory_order_relaxed);
+		shard.mLock.Unlock();
+	}
+
+	// Per-thread xorshift generator; shard choice needs speed, not quality.
+	static uint64_t nextRandom() noexcept
+	{
+		thread_local uint64_t state = std::hash<std::thread::id>()(std::this_thread::get_id()) | 1;
+		state ^= state << 13;
+		state ^= state >> 7;
+		state ^= state << 17;
+		return state;
+	}
+
+private:
+	Compare mCompare;
+	[[no_unique_address]] ShardAllocator mAllocator;
+	const size_t mShardCount;
+	Shard* const mShards;
+};
+
+} // namespace abouttt
@@ -0,0 +1,174 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <type_traits>
+
+#include "Array.h"
+#include "Memory.h"
+
+namespace abouttt
+{
+
+// Frozen copy of a sorted sequence, stored in Eytzinger (breadth-first) order so
+// that a search walks the implicit binary tree from slot 1 and the children of
+// slot k sit at 2k and 2k + 1. The descent has no data-dependent branches, and
+// since the descendants a few levels down share a cache line, each step prefetches
+// them well before they are compared. On tables larger than the last-level cache
+// this beats std::lower_bound by several times; on small ones they are even.
+//
+// The searches return pointers into the index, or nullptr, rather than positions
+// in the sorted input. Keys may be of any type that Compare orders against T.
+template <typename T, typename Compare = std::less<T>, typename Allocator = std::allocator<T>>
+class EytzingerArray
+{
+	static_assert(std::is_same_v<typename Allocator::value_type, T>, "Allocator::value_type must be T");
+
+public:
+	using AllocatorType = Allocator;
+
+public:
+	// Descendants of slot k that are prefetched together, at slot k * PREFETCH_STRIDE.
+	static constexpr size_t PREFETCH_STRIDE = std::max<size_t>(1, CACHE_LINE_SIZE / sizeof(T));
+
+public:
+	EytzingerArray() noexcept(std::is_nothrow_default_constructible_v<Allocator> && std::is_nothrow_default_constructible_v<Compare>)
+		: EytzingerArray(Allocator())
+	{
+	}
+
+	explicit EytzingerArray(const Allocator& alloc) noexcept(std::is_nothrow_default_constructible_v<Compare>)
+		: mData(alloc)
+		, mComp()
+	{
+	}
+
+	// Sorted must be ordered by comp.
+	EytzingerArray(const T* sorted, size_t count, const Compare& comp = Compare(), const Allocator& alloc = Allocator())
+		: mData(alloc)
+		, mComp(comp)
+	{
+		build(sorted, count);
+	}
+
+	template <typename Growth, size_t N>
+	explicit EytzingerArray(const Array<T, Allocator, Growth, N>& sorted, const Compare& comp = Compare())
+		: EytzingerArray(sorted.Data(), sorted.Count(), comp, sorted.GetAllocator())
+	{
+	}
+
+public:
+	template <typename K>
+	bool Contains(const K& key) const
+	{
+		return Find(key) != nullptr;
+	}
+
+	size_t Count() const noexcept
+	{
+		return mData.IsEmpty() ? 0 : mData.Count() - 1;
+	}
+
+	// An element equivalent to key, or nullptr.
+	template <typename K>
+	const T* Find(const K& key) const
+	{
+		const T* element = LowerBound(key);
+		return element && !mComp(key, *element) ? element : nullptr;
+	}
+
+	Allocator GetAllocator() const noexcept
+	{
+		return mData.GetAllocator();
+	}
+
+	bool IsEmpty() const noexcept
+	{
+		return mData.IsEmpty();
+	}
+
+	// The smallest element not less than key, or nullptr.
+	template <typename K>
+	const T* LowerBound(const K& key) const
+	{
+		return descend([&](const T& element) { return mComp(element, key); });
+	}
+
+	// The smallest element greater than key, or nullptr.
+	template <typename K>
+	const T* UpperBound(const K& key) const
+	{
+		return descend([&](const T& element) { return !mComp(key, element); });
+	}
+
+private:
+	// Slot 0 holds a copy of the smallest element so that node k lives at index k
+	// without requiring T to be default constructible; it is never searched.
+	void build(const T* sorted, size_t count)
+	{
+		if (count == 0)
+		{
+			return;
+		}
+
+		// An in-order walk of the implicit tree visits the slots in sorted order.
+		Array<size_t> ranks;
+		ranks.ResizeUninitialized(count + 1);
+		size_t k = 1;
+		while (2 * k <= count)
+		{
+			k *= 2;
+		}
+		for (size_t i = 0; i < count; ++i)
+		{
+			ranks[k] = i;
+			if (2 * k + 1 <= count)
+			{
+				k = 2 * k + 1;
+				while (2 * k <= count)
+				{
+					k *= 2;
+				}
+			}
+			else
+			{
+				k >>= std::countr_one(k) + 1;
+			}
+		}
+
+		mData.Reserve(count + 1);
+		mData.Add(sorted[0]);
+		for (k = 1; k <= count; ++k)
+		{
+			mData.Add(sorted[ranks[k]]);
+		}
+	}
+
+	// Walks down to a leaf, going right whenever goRight holds. The answer is the
+	// last node at which the walk went left, found by stripping the trailing right
+	// turns and that left turn off the final slot number.
+	template <typename GoRight>
+	const T* descend(GoRight goRight) const
+	{
+		const T* data = mData.Data();
+		size_t count = Count();
+		size_t k = 1;
+		while (k <= count)
+		{
+			Prefetch(reinterpret_cast<const void*>(reinterpret_cast<uintptr_t>(data) + sizeof(T) * PREFETCH_STRIDE * k));
+			k = 2 * k + static_cast<size_t>(goRight(data[k]));
+		}
+		k >>= std::countr_one(k) + 1;
+		return k != 0 ? data + k : nullptr;
+	}
+
+private:
+	Array<T, Allocator> mData;
+	[[no_unique_address]] Compare mComp;
+};
+
+} // namespace abouttt
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace abouttt
+{
+
+// A growth policy decides how far a contiguous container grows when an insertion
+// needs more room: Grow(capacity, minCapacity, elementSize) returns a capacity of at
+// least minCapacity. A policy may also define
+//   static void OnReallocate(size_t oldCapacityBytes, size_t newCapacityBytes,
+//       size_t movedBytes, size_t usedBytes) noexcept;
+// which containers call after every reallocation, including those made by Reserve
+// and Shrink.
+
+// Starts at 8 elements and grows by 1.5x.
+struct DefaultGrowth
+{
+	static size_t Grow(size_t capacity, size_t minCapacity, size_t /*elementSize*/) noexcept
+	{
+		size_t grow = capacity + (capacity >> 1);
+		return std::max(minCapacity, capacity == 0 ? 8 : grow);
+	}
+};
+
+// Starts at 8 elements and doubles.
+struct DoublingGrowth
+{
+	static size_t Grow(size_t capacity, size_t minCapacity, size_t /*elementSize*/) noexcept
+	{
+		return std::max(minCapacity, capacity == 0 ? 8 : capacity * 2);
+	}
+};
+
+// Grows to exactly what is needed, for memory-capped containers.
+struct ExactGrowth
+{
+	static size_t Grow(size_t /*capacity*/, size_t minCapacity, size_t /*elementSize*/) noexcept
+	{
+		return minCapacity;
+	}
+};
+
+// Applies Base, then rounds the buffer up to a whole number of PageBytes pages.
+template <typename Base = DefaultGrowth, size_t PageBytes = 4096>
+struct PageRoundedGrowth
+{
+	static size_t Grow(size_t capacity, size_t minCapacity, size_t elementSize) noexcept
+	{
+		size_t newCapacity = Base::Grow(capacity, minCapacity, elementSize);
+		size_t bytes = (newCapacity * elementSize + PageBytes - 1) / PageBytes * PageBytes;
+		return std::max(newCapacity, bytes / elementSize);
+	}
+};
+
+// Counters shared by every container using the same TrackedGrowth type.
+struct GrowthStats
+{
+	std::atomic<uint64_t> mReallocations{ 0 };
+	// Bytes copied or moved into new buffers; in-place remaps move nothing.
+	std::atomic<uint64_t> mBytesMoved{ 0 };
+	std::atomic<uint64_t> mPeakCapacityBytes{ 0 };
+	// Unused capacity right after each reallocation, summed over all of them.
+	std::atomic<uint64_t> mSlackBytes{ 0 };
+
+	void Reset() noexcept
+	{
+		mReallocations.store(0, std::memory_order_relaxed);
+		mBytesMoved.store(0, std::memory_order_relaxed);
+		mPeakCapacityBytes.store(0, std::memory_order_relaxed);
+		mSlackBytes.store(0, std::memory_order_relaxed);
+	}
+};
+
+// Grows like Base and records reallocations in Stats(). Tag separates the counters
+// of unrelated containers that would otherwise share a policy type.
+template <typename Base = DefaultGrowth, typename Tag = void>
+struct TrackedGrowth
+{
+	static size_t Grow(size_t capacity, size_t minCapacity, size_t elementSize) noexcept
+	{
+		return Base::Grow(capacity, minCapacity, elementSize);
+	}
+
+	static void OnReallocate(size_t /*oldCapacityBytes*/, size_t newCapacityBytes, size_t movedBytes, size_t usedBytes) noexcept
+	{
+		GrowthStats& stats = Stats();
+		stats.mReallocations.fetch_add(1, std::memory_order_relaxed);
+		stats.mBytesMoved.fetch_add(movedBytes, std::memory_order_relaxed);
+		stats.mSlackBytes.fetch_add(newCapacityBytes - usedBytes, std::memory_order_relaxed);
+
+		uint64_t peak = stats.mPeakCapacityBytes.load(std::memory_order_relaxed);
+		while (peak < newCapacityBytes &&
+			!stats.mPeakCapacityBytes.compare_exchange_weak(peak, newCapacityBytes, std::memory_order_relaxed))
+		{
+		}
+	}
+
+	static GrowthStats& Stats() noexcept
+	{
+		static GrowthStats stats;
+		return stats;
+	}
+};
+
+// Forwards a reallocation to Growth::OnReallocate when the policy defines it.
+template <typename Growth>
+void RecordReallocation(size_t oldCapacityBytes, size_t newCapacityBytes, size_t movedBytes, size_t usedBytes) noexcept
+{
+	if constexpr (requires { Growth::OnReallocate(oldCapacityBytes, newCapacityBytes, movedBytes, usedBytes); })
+	{
+		Growth::OnReallocate(oldCapacityBytes, newCapacityBytes, movedBytes, usedBytes);
+	}
+}
+
+} // namespace abouttt
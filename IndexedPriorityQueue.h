@@ -0,0 +1,384 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "Array.h"
+
+namespace abouttt
+{
+
+// Addressable priority queue. Enqueue returns a handle that stays valid until its
+// element is dequeued or removed. Its slot is then recycled for later elements,
+// but under a new generation, so a stale handle is rejected rather than reaching
+// whichever element took the slot over. A position index kept next to the heap
+// lets elements be reprioritized or removed by handle in O(log n).
+//
+// As with PriorityQueue, the element for which Compare ranks every other element
+// lower is on top. IncreaseKey moves an element towards the top and DecreaseKey
+// away from it; with std::greater (a min-queue, as in Dijkstra) lowering a
+// distance is therefore an IncreaseKey. Update works in either direction.
+template <typename T, typename Compare = std::less<T>, typename Allocator = std::allocator<T>, size_t Arity = 2>
+class IndexedPriorityQueue
+{
+	static_assert(std::is_same_v<typename Allocator::value_type, T>, "Allocator::value_type must be T");
+	static_assert(Arity >= 2, "IndexedPriorityQueue arity must be at least 2");
+
+public:
+	using Handle = uint64_t;
+	using AllocatorType = Allocator;
+
+private:
+	// A handle is its slot in the low bits and a generation in the high bits.
+	static constexpr unsigned HANDLE_SLOT_BITS = 32;
+	static constexpr Handle HANDLE_SLOT_MASK = (Handle(1) << HANDLE_SLOT_BITS) - 1;
+
+	struct Slot
+	{
+		size_t mPosition;
+		Handle mHandle;
+	};
+
+	struct Entry
+	{
+		template <typename... Args>
+		explicit Entry(Handle handle, Args&&... args)
+			: mValue(std::forward<Args>(args)...)
+			, mHandle(handle)
+		{
+		}
+
+		T mValue;
+		Handle mHandle;
+	};
+
+	using EntryAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Entry>;
+	using SlotAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Slot>;
+	using IndexAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<size_t>;
+
+	static constexpr size_t POSITION_NONE = Array<size_t>::INDEX_NONE;
+
+public:
+	static constexpr Handle HANDLE_NONE = std::numeric_limits<Handle>::max();
+
+public:
+	IndexedPriorityQueue() noexcept
+		: IndexedPriorityQueue(Compare())
+	{
+	}
+
+	explicit IndexedPriorityQueue(const Compare& comp, const Allocator& alloc = Allocator()) noexcept
+		: mCompare(comp)
+		, mHeap(EntryAllocator(alloc))
+		, mSlots(SlotAllocator(alloc))
+		, mFreeSlots(IndexAllocator(alloc))
+		, mNextGeneration(0)
+	{
+	}
+
+	explicit IndexedPriorityQueue(const Allocator& alloc) noexcept
+		: IndexedPriorityQueue(Compare(), alloc)
+	{
+	}
+
+	explicit IndexedPriorityQueue(size_t capacity, const Compare& comp = Compare(), const Allocator& alloc = Allocator())
+		: IndexedPriorityQueue(comp, alloc)
+	{
+		Reserve(capacity);
+	}
+
+public:
+	void Clear() noexcept
+	{
+		mHeap.Clear();
+		mSlots.Clear();
+		mFreeSlots.Clear();
+	}
+
+	bool Contains(Handle handle) const noexcept
+	{
+		size_t slot = static_cast<size_t>(handle & HANDLE_SLOT_MASK);
+		if (slot >= mSlots.Count())
+		{
+			return false;
+		}
+		const Slot& current = mSlots.GetUnchecked(slot);
+		return current.mHandle == handle && current.mPosition != POSITION_NONE;
+	}
+
+	size_t Count() const noexcept
+	{
+		return mHeap.Count();
+	}
+
+	// The new value must not rank higher than the current one.
+	template <typename U>
+	void DecreaseKey(Handle handle, U&& value)
+	{
+		size_t index = checkHandle(handle);
+		mHeap.GetUnchecked(index).mValue = std::forward<U>(value);
+		heapifyDown(index);
+	}
+
+	void Dequeue()
+	{
+		checkEmpty();
+		removeAt(0);
+	}
+
+	template <typename... Args>
+	Handle Emplace(Args&&... args)
+	{
+		bool bRecycled = !mFreeSlots.IsEmpty();
+		size_t slot = bRecycled ? mFreeSlots.GetUnchecked(mFreeSlots.Count() - 1) : mSlots.Count();
+		if (!bRecycled)
+		{
+			if (slot > HANDLE_SLOT_MASK)
+			{
+				throw std::length_error("Too many priority queue handles");
+			}
+			mSlots.Add(Slot{ POSITION_NONE, HANDLE_NONE });
+		}
+
+		Handle handle = (Handle(mNextGeneration) << HANDLE_SLOT_BITS) | slot;
+		try
+		{
+			mHeap.Emplace(handle, std::forward<Args>(args)...);
+		}
+		catch (...)
+		{
+			if (!bRecycled)
+			{
+				mSlots.RemoveAt(slot);
+			}
+			throw;
+		}
+		if (bRecycled)
+		{
+			mFreeSlots.RemoveAt(mFreeSlots.Count() - 1);
+		}
+		++mNextGeneration;
+
+		mSlots.GetUnchecked(slot).mHandle = handle;
+		heapifyUp(mHeap.Count() - 1);
+		return handle;
+	}
+
+	Handle Enqueue(const T& value)
+	{
+		return Emplace(value);
+	}
+
+	Handle Enqueue(T&& value)
+	{
+		return Emplace(std::move(value));
+	}
+
+	const T& Get(Handle handle) const
+	{
+		return mHeap.GetUnchecked(checkHandle(handle)).mValue;
+	}
+
+	Allocator GetAllocator() const noexcept
+	{
+		return Allocator(mHeap.GetAllocator());
+	}
+
+	// The new value must not rank lower than the current one.
+	template <typename U>
+	void IncreaseKey(Handle handle, U&& value)
+	{
+		size_t index = checkHandle(handle);
+		mHeap.GetUnchecked(index).mValue = std::forward<U>(value);
+		heapifyUp(index);
+	}
+
+	bool IsEmpty() const noexcept
+	{
+		return mHeap.IsEmpty();
+	}
+
+	const T& Peek() const
+	{
+		checkEmpty();
+		return mHeap.GetUnchecked(0).mValue;
+	}
+
+	Handle PeekHandle() const
+	{
+		checkEmpty();
+		return mHeap.GetUnchecked(0).mHandle;
+	}
+
+	void Remove(Handle handle)
+	{
+		removeAt(checkHandle(handle));
+	}
+
+	void Reserve(size_t newCapacity)
+	{
+		mHeap.Reserve(newCapacity);
+		mSlots.Reserve(newCapacity);
+	}
+
+	// Also releases the highest slots once none of them is live. Live handles keep
+	// their values.
+	void Shrink()
+	{
+		size_t slotCount = mSlots.Count();
+		while (slotCount > 0 && mSlots.GetUnchecked(slotCount - 1).mPosition == POSITION_NONE)
+		{
+			--slotCount;
+		}
+		if (slotCount < mSlots.Count())
+		{
+			mFreeSlots.RemoveAll([&](size_t slot) { return slot >= slotCount; });
+			mSlots.RemoveAt(slotCount, mSlots.Count() - slotCount);
+		}
+
+		mHeap.Shrink();
+		mSlots.Shrink();
+		mFreeSlots.Shrink();
+	}
+
+	void Swap(IndexedPriorityQueue& other) noexcept
+	{
+		std::swap(mCompare, other.mCompare);
+		mHeap.Swap(other.mHeap);
+		mSlots.Swap(other.mSlots);
+		mFreeSlots.Swap(other.mFreeSlots);
+		std::swap(mNextGeneration, other.mNextGeneration);
+	}
+
+	template <typename U>
+	void Update(Handle handle, U&& value)
+	{
+		size_t index = checkHandle(handle);
+		Entry& entry = mHeap.GetUnchecked(index);
+		bool bRaised = mCompare(entry.mValue, value);
+		entry.mValue = std::forward<U>(value);
+		if (bRaised)
+		{
+			heapifyUp(index);
+		}
+		else
+		{
+			heapifyDown(index);
+		}
+	}
+
+private:
+	void checkEmpty() const
+	{
+		if (mHeap.IsEmpty())
+		{
+			throw std::out_of_range("Priority queue is empty");
+		}
+	}
+
+	size_t checkHandle(Handle handle) const
+	{
+		if (!Contains(handle))
+		{
+			throw std::out_of_range("Invalid priority queue handle");
+		}
+		return mSlots.GetUnchecked(static_cast<size_t>(handle & HANDLE_SLOT_MASK)).mPosition;
+	}
+
+	void heapifyUp(size_t index)
+	{
+		Entry* data = mHeap.Data();
+		Entry entry = std::move(data[index]);
+
+		while (index > 0)
+		{
+			size_t parent = (index - 1) / Arity;
+			if (!mCompare(data[parent].mValue, entry.mValue))
+			{
+				break;
+			}
+			place(index, std::move(data[parent]));
+			index = parent;
+		}
+
+		place(index, std::move(entry));
+	}
+
+	void heapifyDown(size_t index)
+	{
+		Entry* data = mHeap.Data();
+		size_t count = mHeap.Count();
+		Entry entry = std::move(data[index]);
+		size_t child;
+
+		while ((child = index * Arity + 1) < count)
+		{
+			size_t last = std::min(child + Arity, count);
+			for (size_t sibling = child + 1; sibling < last; ++sibling)
+			{
+				if (mCompare(data[child].mValue, data[sibling].mValue))
+				{
+					child = sibling;
+				}
+			}
+
+			if (!mCompare(entry.mValue, data[child].mValue))
+			{
+				break;
+			}
+
+			place(index, std::move(data[child]));
+			index = child;
+		}
+
+		place(index, std::move(entry));
+	}
+
+	void place(size_t index, Entry&& entry)
+	{
+		mSlots.GetUnchecked(static_cast<size_t>(entry.mHandle & HANDLE_SLOT_MASK)).mPosition = index;
+		mHeap.GetUnchecked(index) = std::move(entry);
+	}
+
+	void removeAt(size_t index)
+	{
+		size_t slot = static_cast<size_t>(mHeap.GetUnchecked(index).mHandle & HANDLE_SLOT_MASK);
+		mFreeSlots.Add(slot);
+		mSlots.GetUnchecked(slot).mPosition = POSITION_NONE;
+
+		size_t last = mHeap.Count() - 1;
+		if (index != last)
+		{
+			mHeap.GetUnchecked(index) = std::move(mHeap.GetUnchecked(last));
+			mHeap.RemoveAt(last);
+			if (index > 0 && mCompare(mHeap.GetUnchecked((index - 1) / Arity).mValue, mHeap.GetUnchecked(index).mValue))
+			{
+				heapifyUp(index);
+			}
+			else
+			{
+				heapifyDown(index);
+			}
+		}
+		else
+		{
+			mHeap.RemoveAt(last);
+		}
+	}
+
+private:
+	Compare mCompare;
+	Array<Entry, EntryAllocator> mHeap;
+	Array<Slot, SlotAllocator> mSlots;
+	Array<size_t, IndexAllocator> mFreeSlots;
+	uint32_t mNextGeneration;
+};
+
+} // namespace abouttt
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+
+#include "Array.h"
+#include "GrowthPolicy.h"
+
+namespace abouttt
+{
+
+// Array that keeps up to N elements inside the object and spills to the heap
+// only when it grows past N.
+template <typename T, size_t N, typename Allocator = std::allocator<T>, typename Growth = DefaultGrowth>
+using InlineArray = Array<T, Allocator, Growth, N>;
+
+} // namespace abouttt
@@ -0,0 +1,164 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Compiled out unless ABOUTTT_INSTRUMENTATION is defined to 1, in which case the
+// containers report their expensive internal events through Instrumentation.
+#ifndef ABOUTTT_INSTRUMENTATION
+#define ABOUTTT_INSTRUMENTATION 0
+#endif
+
+#if ABOUTTT_INSTRUMENTATION && defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define ABOUTTT_HAS_USDT 1
+#endif
+#endif
+
+#ifndef ABOUTTT_HAS_USDT
+#define ABOUTTT_HAS_USDT 0
+#endif
+
+// Reports an event from inside a container. The arguments are not evaluated
+// when instrumentation is disabled.
+#if ABOUTTT_INSTRUMENTATION
+#define ABOUTTT_INSTRUMENT(event, container, instance, bytes, value) \
+	::abouttt::Instrumentation::Record(::abouttt::InstrumentationEvent::event, container, instance, bytes, value)
+#else
+#define ABOUTTT_INSTRUMENT(event, container, instance, bytes, value) ((void)0)
+#endif
+
+namespace abouttt
+{
+
+enum class InstrumentationEvent : uint8_t
+{
+	// A buffer was replaced or remapped. Bytes: moved into the new buffer.
+	// Value: new capacity in bytes.
+	Reallocate,
+	// Elements were shifted to open or close a gap. Bytes: shifted. Value: elements.
+	Shift,
+	// A ring buffer index wrapped back to slot 0. Value: capacity in elements.
+	WrapAround,
+	// A heap sift finished. Bytes: moved. Value: levels traversed.
+	Heapify,
+	// A list node was allocated. Bytes: node size. Value: 1.
+	NodeAllocate,
+	// List nodes were freed, one by one or by a bulk pool release. Bytes: their
+	// total size. Value: node count.
+	NodeFree,
+};
+
+inline constexpr size_t INSTRUMENTATION_EVENT_COUNT = 6;
+
+struct InstrumentationRecord
+{
+	InstrumentationEvent mEvent;
+	// Container kind, such as "Array" or "Queue".
+	const char* mContainer;
+	// Identifies the container instance that raised the event.
+	const void* mInstance;
+	size_t mBytes;
+	size_t mValue;
+};
+
+using InstrumentationCallback = void (*)(const InstrumentationRecord& record) noexcept;
+
+// Process-wide totals per event kind.
+struct InstrumentationCounters
+{
+	std::atomic<uint64_t> mEvents[INSTRUMENTATION_EVENT_COUNT] = {};
+	std::atomic<uint64_t> mBytes[INSTRUMENTATION_EVENT_COUNT] = {};
+
+	uint64_t Bytes(InstrumentationEvent event) const noexcept
+	{
+		return mBytes[static_cast<size_t>(event)].load(std::memory_order_relaxed);
+	}
+
+	uint64_t Events(InstrumentationEvent event) const noexcept
+	{
+		return mEvents[static_cast<size_t>(event)].load(std::memory_order_relaxed);
+	}
+
+	void Reset() noexcept
+	{
+		for (size_t i = 0; i < INSTRUMENTATION_EVENT_COUNT; ++i)
+		{
+			mEvents[i].store(0, std::memory_order_relaxed);
+			mBytes[i].store(0, std::memory_order_relaxed);
+		}
+	}
+};
+
+// Every event bumps Counters(), fires the USDT probe abouttt:<event> when
+// <sys/sdt.h> is available, then calls the installed callback, if any. The
+// probes take (container, instance, bytes, value), so perf and bpftrace can
+// attribute memory traffic without rebuilding.
+class Instrumentation
+{
+public:
+	static InstrumentationCounters& Counters() noexcept
+	{
+		static InstrumentationCounters counters;
+		return counters;
+	}
+
+	static InstrumentationCallback GetCallback() noexcept
+	{
+		return callback().load(std::memory_order_acquire);
+	}
+
+	static void Record(InstrumentationEvent event, const char* container, const void* instance, size_t bytes, size_t value) noexcept
+	{
+		InstrumentationCounters& counters = Counters();
+		counters.mEvents[static_cast<size_t>(event)].fetch_add(1, std::memory_order_relaxed);
+		counters.mBytes[static_cast<size_t>(event)].fetch_add(bytes, std::memory_order_relaxed);
+
+#if ABOUTTT_HAS_USDT
+		switch (event)
+		{
+		case InstrumentationEvent::Reallocate:
+			DTRACE_PROBE4(abouttt, reallocate, container, instance, bytes, value);
+			break;
+		case InstrumentationEvent::Shift:
+			DTRACE_PROBE4(abouttt, shift, container, instance, bytes, value);
+			break;
+		case InstrumentationEvent::WrapAround:
+			DTRACE_PROBE4(abouttt, wrap_around, container, instance, bytes, value);
+			break;
+		case InstrumentationEvent::Heapify:
+			DTRACE_PROBE4(abouttt, heapify, container, instance, bytes, value);
+			break;
+		case InstrumentationEvent::NodeAllocate:
+			DTRACE_PROBE4(abouttt, node_allocate, container, instance, bytes, value);
+			break;
+		case InstrumentationEvent::NodeFree:
+			DTRACE_PROBE4(abouttt, node_free, container, instance, bytes, value);
+			break;
+		}
+#endif
+
+		if (InstrumentationCallback cb = GetCallback())
+		{
+			cb(InstrumentationRecord{ event, container, instance, bytes, value });
+		}
+	}
+
+	// The callback may run on any thread and must not use the container that raised
+	// the event. Pass nullptr to remove it.
+	static void SetCallback(InstrumentationCallback cb) noexcept
+	{
+		callback().store(cb, std::memory_order_release);
+	}
+
+private:
+	static std::atomic<InstrumentationCallback>& callback() noexcept
+	{
+		static std::atomic<InstrumentationCallback> cb{ nullptr };
+		return cb;
+	}
+};
+
+} // namespace abouttt
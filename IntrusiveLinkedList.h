@@ -0,0 +1,485 @@
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+namespace abouttt
+{
+
+template <typename T, typename Hook>
+class IntrusiveLinkedList;
+
+template <typename T, typename Hook>
+class IntrusiveLinkedListIterator;
+
+// Links embedded in an object so that IntrusiveLinkedList can chain it without
+// allocating. Embed it as a base class (IntrusiveBaseHook) or as a member
+// (IntrusiveMemberHook); an object needs one hook, with its own Tag, per list it
+// can be on at the same time. A hook unlinks itself when destroyed, and copies of
+// an object start out unlinked.
+template <typename Tag = void>
+class IntrusiveListHook
+{
+public:
+	template <typename, typename>
+	friend class IntrusiveLinkedList;
+	template <typename, typename>
+	friend class IntrusiveLinkedListIterator;
+
+public:
+	IntrusiveListHook() noexcept
+		: mNext(nullptr)
+		, mPrev(nullptr)
+	{
+	}
+
+	IntrusiveListHook(const IntrusiveListHook&) noexcept
+		: IntrusiveListHook()
+	{
+	}
+
+	~IntrusiveListHook()
+	{
+		Unlink();
+	}
+
+public:
+	IntrusiveListHook& operator=(const IntrusiveListHook&) noexcept
+	{
+		return *this;
+	}
+
+public:
+	bool IsLinked() const noexcept
+	{
+		return mNext != nullptr;
+	}
+
+	// Removes the object from whatever list holds it, without access to the list.
+	void Unlink() noexcept
+	{
+		if (mNext)
+		{
+			mPrev->mNext = mNext;
+			mNext->mPrev = mPrev;
+			mNext = nullptr;
+			mPrev = nullptr;
+		}
+	}
+
+private:
+	void linkBefore(IntrusiveListHook* next) noexcept
+	{
+		mNext = next;
+		mPrev = next->mPrev;
+		mPrev->mNext = this;
+		next->mPrev = this;
+	}
+
+private:
+	IntrusiveListHook* mNext;
+	IntrusiveListHook* mPrev;
+};
+
+// T derives from IntrusiveListHook<Tag>.
+template <typename Tag = void>
+struct IntrusiveBaseHook
+{
+	using HookType = IntrusiveListHook<Tag>;
+
+	template <typename T>
+	static HookType* ToHook(T* object) noexcept
+	{
+		return static_cast<HookType*>(object);
+	}
+
+	template <typename T>
+	static T* FromHook(HookType* hook) noexcept
+	{
+		return static_cast<T*>(hook);
+	}
+};
+
+// Member is a pointer to an IntrusiveListHook data member of T.
+template <auto Member>
+struct IntrusiveMemberHook;
+
+template <typename T, typename Tag, IntrusiveListHook<Tag> T::*Member>
+struct IntrusiveMemberHook<Member>
+{
+	using HookType = IntrusiveListHook<Tag>;
+
+	static HookType* ToHook(T* object) noexcept
+	{
+		return &(object->*Member);
+	}
+
+	template <typename U>
+	static U* FromHook(HookType* hook) noexcept
+	{
+		static_assert(std::is_same_v<U, T>, "IntrusiveMemberHook used with the wrong element type");
+		return reinterpret_cast<T*>(reinterpret_cast<std::byte*>(hook) - offset());
+	}
+
+private:
+	// Offset of the hook within T, measured on uninitialized storage.
+	static std::ptrdiff_t offset() noexcept
+	{
+		alignas(T) static std::byte storage[sizeof(T)];
+		T* probe = reinterpret_cast<T*>(storage);
+		return reinterpret_cast<std::byte*>(&(probe->*Member)) - storage;
+	}
+};
+
+// Doubly linked list of objects that carry their own links. The list neither
+// owns nor allocates anything: adding links the object in place and removing
+// only unlinks it. Adding an object that is already on a list of the same hook
+// moves it.
+//
+// Hooks can unlink themselves, so the list keeps no element count; Count() walks
+// the list while IsEmpty() is O(1).
+template <typename T, typename Hook = IntrusiveBaseHook<>>
+class IntrusiveLinkedList
+{
+private:
+	using HookType = typename Hook::HookType;
+
+public:
+	using Iterator = IntrusiveLinkedListIterator<T, Hook>;
+	using ConstIterator = IntrusiveLinkedListIterator<const T, Hook>;
+
+public:
+	IntrusiveLinkedList() noexcept
+	{
+		mSentinel.mNext = &mSentinel;
+		mSentinel.mPrev = &mSentinel;
+	}
+
+	IntrusiveLinkedList(const IntrusiveLinkedList&) = delete;
+
+	IntrusiveLinkedList(IntrusiveLinkedList&& other) noexcept
+		: IntrusiveLinkedList()
+	{
+		takeAll(other);
+	}
+
+	// Unlinks every element; the objects themselves are untouched.
+	~IntrusiveLinkedList()
+	{
+		Clear();
+		mSentinel.mNext = nullptr;
+	}
+
+public:
+	IntrusiveLinkedList& operator=(const IntrusiveLinkedList&) = delete;
+
+	IntrusiveLinkedList& operator=(IntrusiveLinkedList&& other) noexcept
+	{
+		if (this != &other)
+		{
+			Clear();
+			takeAll(other);
+		}
+		return *this;
+	}
+
+public:
+	void AddHead(T& object) noexcept
+	{
+		Insert(object, Head());
+	}
+
+	void AddTail(T& object) noexcept
+	{
+		Insert(object, nullptr);
+	}
+
+	void Clear() noexcept
+	{
+		HookType* hook = mSentinel.mNext;
+		while (hook != &mSentinel)
+		{
+			HookType* next = hook->mNext;
+			hook->mNext = nullptr;
+			hook->mPrev = nullptr;
+			hook = next;
+		}
+		mSentinel.mNext = &mSentinel;
+		mSentinel.mPrev = &mSentinel;
+	}
+
+	// Walks the list. When an object can only ever be on this list, its hook's
+	// IsLinked() answers the same question in O(1).
+	bool Contains(const T& object) const noexcept
+	{
+		for (const HookType* hook = mSentinel.mNext; hook != &mSentinel; hook = hook->mNext)
+		{
+			if (hook == toHook(object))
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	size_t Count() const noexcept
+	{
+		size_t count = 0;
+		for (const HookType* hook = mSentinel.mNext; hook != &mSentinel; hook = hook->mNext)
+		{
+			++count;
+		}
+		return count;
+	}
+
+	// First element equal to value, or nullptr.
+	T* Find(const T& value)
+	{
+		for (T& object : *this)
+		{
+			if (object == value)
+			{
+				return &object;
+			}
+		}
+		return nullptr;
+	}
+
+	T* FindLast(const T& value)
+	{
+		for (HookType* hook = mSentinel.mPrev; hook != &mSentinel; hook = hook->mPrev)
+		{
+			T* object = fromHook(hook);
+			if (*object == value)
+			{
+				return object;
+			}
+		}
+		return nullptr;
+	}
+
+	T* Head() const noexcept
+	{
+		return mSentinel.mNext != &mSentinel ? fromHook(mSentinel.mNext) : nullptr;
+	}
+
+	// Links object in before before, or at the tail when before is null.
+	void Insert(T& object, T* before) noexcept
+	{
+		HookType* hook = toHook(object);
+		HookType* next = before ? toHook(*before) : &mSentinel;
+		if (hook == next)
+		{
+			return;
+		}
+		hook->Unlink();
+		hook->linkBefore(next);
+	}
+
+	bool IsEmpty() const noexcept
+	{
+		return mSentinel.mNext == &mSentinel;
+	}
+
+	// Next element after object, or nullptr at the tail. Object must be on this list.
+	T* Next(const T& object) const noexcept
+	{
+		HookType* next = toHook(object)->mNext;
+		return next != &mSentinel ? fromHook(next) : nullptr;
+	}
+
+	T* PopHead() noexcept
+	{
+		T* head = Head();
+		if (head)
+		{
+			toHook(*head)->Unlink();
+		}
+		return head;
+	}
+
+	T* PopTail() noexcept
+	{
+		T* tail = Tail();
+		if (tail)
+		{
+			toHook(*tail)->Unlink();
+		}
+		return tail;
+	}
+
+	// Previous element before object, or nullptr at the head. Object must be on this
+	// list.
+	T* Prev(const T& object) const noexcept
+	{
+		HookType* prev = toHook(object)->mPrev;
+		return prev != &mSentinel ? fromHook(prev) : nullptr;
+	}
+
+	// O(1). Returns false if the object was not linked.
+	bool Remove(T& object) noexcept
+	{
+		HookType* hook = toHook(object);
+		if (!hook->IsLinked())
+		{
+			return false;
+		}
+		hook->Unlink();
+		return true;
+	}
+
+	void Swap(IntrusiveLinkedList& other) noexcept
+	{
+		IntrusiveLinkedList temp(std::move(other));
+		other.takeAll(*this);
+		takeAll(temp);
+	}
+
+	T* Tail() const noexcept
+	{
+		return mSentinel.mPrev != &mSentinel ? fromHook(mSentinel.mPrev) : nullptr;
+	}
+
+public: // Iterators for range-based loop support.
+	Iterator begin() noexcept
+	{
+		return Iterator(mSentinel.mNext);
+	}
+
+	ConstIterator begin() const noexcept
+	{
+		return ConstIterator(mSentinel.mNext);
+	}
+
+	Iterator end() noexcept
+	{
+		return Iterator(&mSentinel);
+	}
+
+	ConstIterator end() const noexcept
+	{
+		return ConstIterator(const_cast<HookType*>(&mSentinel));
+	}
+
+private:
+	static HookType* toHook(const T& object) noexcept
+	{
+		return Hook::ToHook(const_cast<T*>(&object));
+	}
+
+	static T* fromHook(HookType* hook) noexcept
+	{
+		return Hook::template FromHook<T>(hook);
+	}
+
+	// Moves every element of other, which may be this list's temporary, to the end
+	// of this list.
+	void takeAll(IntrusiveLinkedList& other) noexcept
+	{
+		if (other.IsEmpty())
+		{
+			return;
+		}
+
+		HookType* first = other.mSentinel.mNext;
+		HookType* last = other.mSentinel.mPrev;
+		other.mSentinel.mNext = &other.mSentinel;
+		other.mSentinel.mPrev = &other.mSentinel;
+
+		first->mPrev = mSentinel.mPrev;
+		mSentinel.mPrev->mNext = first;
+		last->mNext = &mSentinel;
+		mSentinel.mPrev = last;
+	}
+
+private:
+	HookType mSentinel;
+};
+
+template <typename T, typename Hook>
+class IntrusiveLinkedListIterator
+{
+private:
+	using HookType = typename Hook::HookType;
+
+public:
+	friend class IntrusiveLinkedListIterator<const T, Hook>;
+
+public:
+	using iterator_category = std::bidirectional_iterator_tag;
+	using value_type = std::remove_cv_t<T>;
+	using difference_type = std::ptrdiff_t;
+	using pointer = T*;
+	using reference = T&;
+
+public:
+	IntrusiveLinkedListIterator() noexcept
+		: mHook(nullptr)
+	{
+	}
+
+	explicit IntrusiveLinkedListIterator(HookType* hook) noexcept
+		: mHook(hook)
+	{
+	}
+
+	template<typename U = T, typename = std::enable_if_t<std::is_const_v<U>>>
+	IntrusiveLinkedListIterator(const IntrusiveLinkedListIterator<std::remove_const_t<T>, Hook>& other) noexcept
+		: mHook(other.mHook)
+	{
+	}
+
+public:
+	T& operator*() const noexcept
+	{
+		return *Hook::template FromHook<std::remove_const_t<T>>(mHook);
+	}
+
+	T* operator->() const noexcept
+	{
+		return Hook::template FromHook<std::remove_const_t<T>>(mHook);
+	}
+
+	IntrusiveLinkedListIterator& operator++() noexcept
+	{
+		mHook = mHook->mNext;
+		return *this;
+	}
+
+	IntrusiveLinkedListIterator operator++(int) noexcept
+	{
+		IntrusiveLinkedListIterator temp(*this);
+		++(*this);
+		return temp;
+	}
+
+	IntrusiveLinkedListIterator& operator--() noexcept
+	{
+		mHook = mHook->mPrev;
+		return *this;
+	}
+
+	IntrusiveLinkedListIterator operator--(int) noexcept
+	{
+		IntrusiveLinkedListIterator temp(*this);
+		--(*this);
+		return temp;
+	}
+
+	bool operator==(const IntrusiveLinkedListIterator& other) const noexcept
+	{
+		return mHook == other.mHook;
+	}
+
+	bool operator!=(const IntrusiveLinkedListIterator& other) const noexcept
+	{
+		return mHook != other.mHook;
+	}
+
+private:
+	HookType* mHook;
+};
+
+} // namespace abouttt
@@ -3,9 +3,13 @@
 #include <algorithm>
 #include <compare>
 #include <initializer_list>
+#include <memory>
 #include <type_traits>
 #include <utility>
 
+#include "Instrumentation.h"
+#include "NodePool.h"
+
 namespace abouttt
 {
 
@@ -15,23 +19,36 @@ class LinkedListNode;
 template <typename T>
 class LinkedListIterator;
 
-template <typename T>
+template <typename T, typename Allocator = std::allocator<T>>
 class LinkedList
 {
+	static_assert(std::is_same_v<typename Allocator::value_type, T>, "Allocator::value_type must be T");
+
+private:
+	using NodeAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<LinkedListNode<T>>;
+	using NodeAllocatorTraits = std::allocator_traits<NodeAllocator>;
+
 public:
+	using AllocatorType = Allocator;
 	using Iterator = LinkedListIterator<T>;
 	using ConstIterator = LinkedListIterator<const T>;
 
 public:
-	LinkedList() noexcept
-		: mHead(nullptr)
+	LinkedList() noexcept(std::is_nothrow_default_constructible_v<Allocator>)
+		: LinkedList(Allocator())
+	{
+	}
+
+	explicit LinkedList(const Allocator& alloc) noexcept
+		: mAllocator(alloc)
+		, mHead(nullptr)
 		, mTail(nullptr)
 		, mCount(0)
 	{
 	}
 
-	LinkedList(std::initializer_list<T> ilist)
-		: LinkedList()
+	LinkedList(std::initializer_list<T> ilist, const Allocator& alloc = Allocator())
+		: LinkedList(alloc)
 	{
 		for (const T& value : ilist)
 		{
@@ -40,7 +57,12 @@ public:
 	}
 
 	LinkedList(const LinkedList& other)
-		: LinkedList()
+		: LinkedList(other, Allocator(NodeAllocatorTraits::select_on_container_copy_construction(other.mAllocator)))
+	{
+	}
+
+	LinkedList(const LinkedList& other, const Allocator& alloc)
+		: LinkedList(alloc)
 	{
 		for (LinkedListNode<T>* node = other.mHead; node != nullptr; node = node->mNext)
 		{
@@ -49,12 +71,30 @@ public:
 	}
 
 	LinkedList(LinkedList&& other) noexcept
-		: mHead(std::exchange(other.mHead, nullptr))
+		: mAllocator(std::move(other.mAllocator))
+		, mHead(std::exchange(other.mHead, nullptr))
 		, mTail(std::exchange(other.mTail, nullptr))
 		, mCount(std::exchange(other.mCount, 0))
 	{
 	}
 
+	LinkedList(LinkedList&& other, const Allocator& alloc)
+		: LinkedList(alloc)
+	{
+		if (mAllocator == other.mAllocator)
+		{
+			swapNodes(other);
+		}
+		else
+		{
+			for (LinkedListNode<T>* node = other.mHead; node != nullptr; node = node->mNext)
+			{
+				AddTail(std::move(node->mValue));
+			}
+			other.Clear();
+		}
+	}
+
 	~LinkedList()
 	{
 		Clear();
@@ -65,28 +105,45 @@ public:
 	{
 		if (this != &other)
 		{
-			LinkedList temp(other);
-			Swap(temp);
+			if constexpr (NodeAllocatorTraits::propagate_on_container_copy_assignment::value)
+			{
+				if (mAllocator != other.mAllocator)
+				{
+					Clear();
+				}
+				mAllocator = other.mAllocator;
+			}
+			LinkedList temp(other, GetAllocator());
+			swapNodes(temp);
 		}
 		return *this;
 	}
 
-	LinkedList& operator=(LinkedList&& other) noexcept
+	LinkedList& operator=(LinkedList&& other) noexcept(
+		NodeAllocatorTraits::propagate_on_container_move_assignment::value ||
+		NodeAllocatorTraits::is_always_equal::value)
 	{
 		if (this != &other)
 		{
-			Clear();
-			mHead = std::exchange(other.mHead, nullptr);
-			mTail = std::exchange(other.mTail, nullptr);
-			mCount = std::exchange(other.mCount, 0);
+			if constexpr (NodeAllocatorTraits::propagate_on_container_move_assignment::value)
+			{
+				Clear();
+				mAllocator = std::move(other.mAllocator);
+				swapNodes(other);
+			}
+			else
+			{
+				LinkedList temp(std::move(other), GetAllocator());
+				swapNodes(temp);
+			}
 		}
 		return *this;
 	}
 
 	LinkedList& operator=(std::initializer_list<T> ilist)
 	{
-		LinkedList temp(ilist);
-		Swap(temp);
+		LinkedList temp(ilist, GetAllocator());
+		swapNodes(temp);
 		return *this;
 	}
 
@@ -164,12 +221,42 @@ public:
 		return Insert(newNode, nullptr);
 	}
 
+	// Moves every element of other to the tail, relinking nodes in O(1) when the
+	// allocators are equal.
+	void Append(LinkedList&& other)
+	{
+		Splice(nullptr, other);
+	}
+
 	void Clear() noexcept
 	{
+		if constexpr (requires { mAllocator.Pool()->Reset(); })
+		{
+			// Every live block of the pool belongs to this list, so rewind it in one step.
+			if (auto pool = mAllocator.Pool(); pool && pool->LiveCount() == mCount)
+			{
+				if constexpr (!std::is_trivially_destructible_v<T>)
+				{
+					for (LinkedListNode<T>* node = mHead; node != nullptr; )
+					{
+						auto next = node->mNext;
+						std::destroy_at(node);
+						node = next;
+					}
+				}
+				ABOUTTT_INSTRUMENT(NodeFree, "LinkedList", this, sizeof(LinkedListNode<T>) * mCount, mCount);
+				pool->Reset();
+				mHead = nullptr;
+				mTail = nullptr;
+				mCount = 0;
+				return;
+			}
+		}
+
 		while (mHead)
 		{
 			auto next = mHead->mNext;
-			delete mHead;
+			destroyNode(mHead);
 			mHead = next;
 		}
 		mTail = nullptr;
@@ -189,14 +276,14 @@ public:
 	template <typename... Args>
 	LinkedListNode<T>* EmplaceHead(Args&&... args)
 	{
-		LinkedListNode<T>* newNode = new LinkedListNode<T>(std::forward<Args>(args)...);
+		LinkedListNode<T>* newNode = createNode(std::forward<Args>(args)...);
 		return Insert(newNode, mHead) ? newNode : nullptr;
 	}
 
 	template <typename... Args>
 	LinkedListNode<T>* EmplaceTail(Args&&... args)
 	{
-		LinkedListNode<T>* newNode = new LinkedListNode<T>(std::forward<Args>(args)...);
+		LinkedListNode<T>* newNode = createNode(std::forward<Args>(args)...);
 		return Insert(newNode, nullptr) ? newNode : nullptr;
 	}
 
@@ -234,6 +321,11 @@ public:
 		return nullptr;
 	}
 
+	Allocator GetAllocator() const noexcept
+	{
+		return Allocator(mAllocator);
+	}
+
 	LinkedListNode<T>* Head() const noexcept
 	{
 		return mHead;
@@ -241,16 +333,17 @@ public:
 
 	void Insert(const T& value, LinkedListNode<T>* before)
 	{
-		LinkedListNode<T>* newNode = new LinkedListNode<T>(value);
+		LinkedListNode<T>* newNode = createNode(value);
 		Insert(newNode, before);
 	}
 
 	void Insert(T&& value, LinkedListNode<T>* before)
 	{
-		LinkedListNode<T>* newNode = new LinkedListNode<T>(std::move(value));
+		LinkedListNode<T>* newNode = createNode(std::move(value));
 		Insert(newNode, before);
 	}
 
+	// Nodes linked in by pointer are released through the list's allocator on Clear() or Remove().
 	bool Insert(LinkedListNode<T>* newNode, LinkedListNode<T>* before)
 	{
 		if (!newNode)
@@ -297,6 +390,16 @@ public:
 		return mCount == 0;
 	}
 
+	bool MoveToHead(LinkedListNode<T>* node) noexcept
+	{
+		return node && (node == mHead || (Remove(node, false) && Insert(node, mHead)));
+	}
+
+	bool MoveToTail(LinkedListNode<T>* node) noexcept
+	{
+		return node && (node == mTail || (Remove(node, false) && Insert(node, nullptr)));
+	}
+
 	bool Remove(const T& value)
 	{
 		LinkedListNode<T>* node = Find(value);
@@ -333,7 +436,7 @@ public:
 
 		if (bDelete)
 		{
-			delete node;
+			destroyNode(node);
 		}
 		else
 		{
@@ -346,6 +449,101 @@ public:
 		return true;
 	}
 
+	// The Splice overloads move nodes of other, which may be this list, in front of
+	// before, or to the tail when before is null. before must not be among the moved
+	// nodes. Nodes are relinked in O(1) when the allocators are equal; otherwise the
+	// values are moved into new nodes.
+	void Splice(LinkedListNode<T>* before, LinkedList& other)
+	{
+		if (&other != this && other.mHead)
+		{
+			Splice(before, other, other.mHead, nullptr, other.mCount);
+		}
+	}
+
+	void Splice(LinkedListNode<T>* before, LinkedList& other, LinkedListNode<T>* node)
+	{
+		if (node && node != before)
+		{
+			Splice(before, other, node, node->mNext, 1);
+		}
+	}
+
+	// Moves [first, last); a null last runs through other's tail. Counting the range
+	// costs O(k) unless other is this list.
+	void Splice(LinkedListNode<T>* before, LinkedList& other, LinkedListNode<T>* first, LinkedListNode<T>* last)
+	{
+		size_t count = 0;
+		if (&other != this)
+		{
+			for (LinkedListNode<T>* node = first; node != last; node = node->mNext)
+			{
+				++count;
+			}
+		}
+		Splice(before, other, first, last, count);
+	}
+
+	// Moves [first, last), which holds count nodes, in O(1).
+	void Splice(LinkedListNode<T>* before, LinkedList& other, LinkedListNode<T>* first, LinkedListNode<T>* last, size_t count)
+	{
+		if (!first || first == last)
+		{
+			return;
+		}
+
+		if (&other != this && mAllocator != other.mAllocator)
+		{
+			while (first != last)
+			{
+				LinkedListNode<T>* next = first->mNext;
+				Insert(std::move(first->mValue), before);
+				other.Remove(first);
+				first = next;
+			}
+			return;
+		}
+
+		LinkedListNode<T>* back = last ? last->mPrev : other.mTail;
+		(first->mPrev ? first->mPrev->mNext : other.mHead) = last;
+		(last ? last->mPrev : other.mTail) = first->mPrev;
+		other.mCount -= count;
+
+		LinkedListNode<T>* prev = before ? before->mPrev : mTail;
+		first->mPrev = prev;
+		back->mNext = before;
+		(prev ? prev->mNext : mHead) = first;
+		(before ? before->mPrev : mTail) = back;
+		mCount += count;
+	}
+
+	// Moves node and everything after it into the returned list. Counting the moved
+	// nodes walks from node toward both ends at once, so it costs O(min(k, n - k)).
+	LinkedList SplitAt(LinkedListNode<T>* node)
+	{
+		LinkedList result(GetAllocator());
+		if (!node)
+		{
+			return result;
+		}
+
+		size_t forwardCount = 0;
+		size_t backwardCount = 0;
+		LinkedListNode<T>* forward = node;
+		LinkedListNode<T>* backward = node->mPrev;
+		while (forward && backward)
+		{
+			forward = forward->mNext;
+			backward = backward->mPrev;
+			++forwardCount;
+			++backwardCount;
+		}
+		size_t count = forward ? mCount - backwardCount : forwardCount;
+
+		result.Splice(nullptr, *this, node, nullptr, count);
+		return result;
+	}
+
 	LinkedListNode<T>* Tail() const noexcept
 	{
 		return mTail;
@@ -353,9 +551,11 @@ public:
 
 	void Swap(LinkedList& other) noexcept
 	{
-		std::swap(mHead, other.mHead);
-		std::swap(mTail, other.mTail);
-		std::swap(mCount, other.mCount);
+		if constexpr (NodeAllocatorTraits::propagate_on_container_swap::value)
+		{
+			std::swap(mAllocator, other.mAllocator);
+		}
+		swapNodes(other);
 	}
 
 public: // Iterators for range-based loop support.
@@ -380,6 +580,39 @@ public: // Iterators for range-based loop support.
 	}
 
 private:
+	template <typename... Args>
+	LinkedListNode<T>* createNode(Args&&... args)
+	{
+		LinkedListNode<T>* node = NodeAllocatorTraits::allocate(mAllocator, 1);
+		try
+		{
+			std::construct_at(node, std::forward<Args>(args)...);
+		}
+		catch (...)
+		{
+			NodeAllocatorTraits::deallocate(mAllocator, node, 1);
+			throw;
+		}
+		ABOUTTT_INSTRUMENT(NodeAllocate, "LinkedList", this, sizeof(LinkedListNode<T>), 1);
+		return node;
+	}
+
+	void destroyNode(LinkedListNode<T>* node) noexcept
+	{
+		std::destroy_at(node);
+		NodeAllocatorTraits::deallocate(mAllocator, node, 1);
+		ABOUTTT_INSTRUMENT(NodeFree, "LinkedList", this, sizeof(LinkedListNode<T>), 1);
+	}
+
+	void swapNodes(LinkedList& other) noexcept
+	{
+		std::swap(mHead, other.mHead);
+		std::swap(mTail, other.mTail);
+		std::swap(mCount, other.mCount);
+	}
+
+private:
+	[[no_unique_address]] NodeAllocator mAllocator;
 	LinkedListNode<T>* mHead;
 	LinkedListNode<T>* mTail;
 	size_t mCount;
@@ -389,8 +622,10 @@ template <typename T>
 class LinkedListNode
 {
 public:
-	friend class LinkedList<T>;
+	template <typename, typename>
+	friend class LinkedList;
 	friend class LinkedListIterator<T>;
+	friend class LinkedListIterator<const T>;
 
 public:
 	template <typename... Args>
@@ -438,16 +673,25 @@ private:
 	LinkedListNode* mPrev;
 };
 
+template <typename T>
+using PooledLinkedList = LinkedList<T, PoolAllocator<T>>;
+
 template <typename T>
 class LinkedListIterator
 {
+private:
+	using Node = LinkedListNode<std::remove_const_t<T>>;
+
+public:
+	friend class LinkedListIterator<const T>;
+
 public:
 	LinkedListIterator() noexcept
 		: mNode(nullptr)
 	{
 	}
 
-	explicit LinkedListIterator(LinkedListNode<T>* node) noexcept
+	explicit LinkedListIterator(Node* node) noexcept
 		: mNode(node)
 	{
 	}
@@ -506,7 +750,7 @@ public:
 	}
 
 private:
-	LinkedListNode<T>* mNode;
+	Node* mNode;
 };
 
 } // namespace abouttt
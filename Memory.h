@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <unistd.h>
+#define ABOUTTT_HAS_PAGE_MAPPING 1
+#else
+#define ABOUTTT_HAS_PAGE_MAPPING 0
+#endif
+
+namespace abouttt
+{
+
+// Alignment used to keep independently written atomics on separate cache lines.
+inline constexpr size_t CACHE_LINE_SIZE = 64;
+
+// Hints that the cache line holding address will be read soon. Never faults, so
+// address may lie past the end of an allocation.
+inline void Prefetch(const void* address) noexcept
+{
+#if defined(__GNUC__) || defined(__clang__)
+	__builtin_prefetch(address);
+#else
+	(void)address;
+#endif
+}
+
+// A type is trivially relocatable when moving an object to new storage and
+// destroying the source is equivalent to copying its bytes. This holds for every
+// trivially copyable type; other types can opt in by specializing the trait.
+template <typename T>
+struct IsTriviallyRelocatable : std::bool_constant<std::is_trivially_copyable_v<T>>
+{
+};
+
+template <typename T, typename Deleter>
+struct IsTriviallyRelocatable<std::unique_ptr<T, Deleter>> : IsTriviallyRelocatable<Deleter>
+{
+};
+
+template <typename T>
+inline constexpr bool IsTriviallyRelocatableV = IsTriviallyRelocatable<std::remove_cv_t<T>>::value;
+
+// Moves count objects into uninitialized, non-overlapping storage and ends the
+// lifetime of the sources.
+template <typename T>
+void RelocateN(T* first, size_t count, T* dest)
+{
+	if constexpr (IsTriviallyRelocatableV<T>)
+	{
+		if (count > 0)
+		{
+			std::memcpy(static_cast<void*>(dest), static_cast<const void*>(first), sizeof(T) * count);
+		}
+	}
+	else
+	{
+		std::uninitialized_move_n(first, count, dest);
+		std::destroy_n(first, count);
+	}
+}
+
+#if ABOUTTT_HAS_PAGE_MAPPING
+
+inline size_t PageSize() noexcept
+{
+	static const size_t pageSize = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+	return pageSize;
+}
+
+// Maps zeroed, private, read-write pages. Returns nullptr on failure.
+inline void* MapPages(size_t bytes) noexcept
+{
+	void* ptr = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	return ptr != MAP_FAILED ? ptr : nullptr;
+}
+
+// Resizes a mapping without copying its contents where the platform allows it.
+// Returns nullptr, leaving the mapping untouched, when it cannot.
+inline void* RemapPages(void* ptr, size_t oldBytes, size_t newBytes) noexcept
+{
+#if defined(__linux__)
+	void* newPtr = ::mremap(ptr, oldBytes, newBytes, MREMAP_MAYMOVE);
+	return newPtr != MAP_FAILED ? newPtr : nullptr;
+#else
+	(void)ptr;
+	(void)oldBytes;
+	(void)newBytes;
+	return nullptr;
+#endif
+}
+
+inline void UnmapPages(void* ptr, size_t bytes) noexcept
+{
+	::munmap(ptr, bytes);
+}
+
+#endif // ABOUTTT_HAS_PAGE_MAPPING
+
+} // namespace abouttt
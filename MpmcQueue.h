@@ -0,0 +1,378 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include "Memory.h"
+#include "SpinWait.h"
+
+namespace abouttt
+{
+
+// Bounded lock-free multi-producer/multi-consumer queue (Vyukov-style). Each slot
+// carries a sequence number telling producers and consumers whose turn it is, so
+// the only contended writes are the CAS on the enqueue and dequeue positions.
+// T must be nothrow move constructible and assignable.
+template <typename T, typename Allocator = std::allocator<T>>
+class MpmcQueue
+{
+	static_assert(std::is_same_v<typename Allocator::value_type, T>, "Allocator::value_type must be T");
+	static_assert(std::is_nothrow_move_constructible_v<T> && std::is_nothrow_move_assignable_v<T>,
+		"MpmcQueue requires nothrow move operations");
+
+private:
+	struct Cell
+	{
+		std::atomic<size_t> mSequence;
+		alignas(T) std::byte mStorage[sizeof(T)];
+
+		T* Value() noexcept
+		{
+			return std::launder(reinterpret_cast<T*>(mStorage));
+		}
+	};
+
+	using CellAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Cell>;
+	using CellAllocatorTraits = std::allocator_traits<CellAllocator>;
+
+public:
+	using AllocatorType = Allocator;
+
+public:
+	// Capacity is rounded up to a power of two.
+	explicit MpmcQueue(size_t capacity, const WaitPolicy& policy = WaitPolicy(), const Allocator& alloc = Allocator())
+		: mAllocator(alloc)
+		, mCapacity(std::bit_ceil(std::max<size_t>(capacity, 2)))
+		, mMask(mCapacity - 1)
+		, mCells(CellAllocatorTraits::allocate(mAllocator, mCapacity))
+		, mPolicy(policy)
+		, mEnqueuePos(0)
+		, mItemSignal(0)
+		, mItemWaiters(0)
+		, mDequeuePos(0)
+		, mSpaceSignal(0)
+		, mSpaceWaiters(0)
+	{
+		for (size_t i = 0; i < mCapacity; ++i)
+		{
+			std::construct_at(&mCells[i].mSequence, i);
+		}
+	}
+
+	MpmcQueue(const MpmcQueue&) = delete;
+
+	~MpmcQueue()
+	{
+		size_t pos = mDequeuePos.load(std::memory_order_relaxed);
+		size_t end = mEnqueuePos.load(std::memory_order_relaxed);
+		for (; pos != end; ++pos)
+		{
+			Cell& cell = mCells[pos & mMask];
+			if (cell.mSequence.load(std::memory_order_relaxed) == pos + 1)
+			{
+				std::destroy_at(cell.Value());
+			}
+		}
+		for (size_t i = 0; i < mCapacity; ++i)
+		{
+			std::destroy_at(&mCells[i].mSequence);
+		}
+		CellAllocatorTraits::deallocate(mAllocator, mCells, mCapacity);
+	}
+
+public:
+	MpmcQueue& operator=(const MpmcQueue&) = delete;
+
+public:
+	size_t Capacity() const noexcept
+	{
+		return mCapacity;
+	}
+
+	// Approximate while other threads are operating on the queue.
+	size_t Count() const noexcept
+	{
+		size_t dequeuePos = mDequeuePos.load(std::memory_order_acquire);
+		size_t enqueuePos = mEnqueuePos.load(std::memory_order_acquire);
+		return enqueuePos > dequeuePos ? std::min(enqueuePos - dequeuePos, mCapacity) : 0;
+	}
+
+	// Blocks until an element is available.
+	void Dequeue(T& outValue)
+	{
+		waitFor(mItemSignal, mItemWaiters, [&] { return TryDequeue(outValue); }, [&] { return itemPending(); });
+	}
+
+	// Moves up to maxCount elements to out and returns how many were dequeued.
+	// Never blocks. Assigning to out must not throw.
+	template <typename OutputIt>
+	size_t DequeueBulk(OutputIt out, size_t maxCount)
+	{
+		size_t dequeued = 0;
+		while (dequeued < maxCount)
+		{
+			size_t pos;
+			size_t claimed = claim(mDequeuePos, 1, maxCount - dequeued, pos);
+			if (claimed == 0)
+			{
+				break;
+			}
+
+			for (size_t i = 0; i < claimed; ++i)
+			{
+				Cell& cell = mCells[(pos + i) & mMask];
+				*out = std::move(*cell.Value());
+				++out;
+				std::destroy_at(cell.Value());
+				cell.mSequence.store(pos + i + mCapacity, std::memory_order_release);
+			}
+			dequeued += claimed;
+		}
+
+		if (dequeued > 0)
+		{
+			notify(mSpaceSignal, mSpaceWaiters);
+		}
+		return dequeued;
+	}
+
+	// Blocks until there is room for the element.
+	template <typename... Args>
+	void Emplace(Args&&... args)
+	{
+		T value(std::forward<Args>(args)...);
+		waitFor(mSpaceSignal, mSpaceWaiters, [&] { return TryEnqueue(std::move(value)); }, [&] { return spacePending(); });
+	}
+
+	void Enqueue(const T& value)
+	{
+		Emplace(value);
+	}
+
+	void Enqueue(T&& value)
+	{
+		Emplace(std::move(value));
+	}
+
+	// Constructs up to count elements from first and returns how many were enqueued.
+	// Never blocks. Constructing T from *first must not throw; pass move iterators
+	// for types whose copy may throw.
+	template <typename InputIt>
+	size_t EnqueueBulk(InputIt first, size_t count)
+	{
+		static_assert(std::is_nothrow_constructible_v<T, std::iter_reference_t<InputIt>>,
+			"EnqueueBulk requires constructing T from the iterator not to throw");
+
+		size_t enqueued = 0;
+		while (enqueued < count)
+		{
+			size_t pos;
+			size_t claimed = claim(mEnqueuePos, 0, count - enqueued, pos);
+			if (claimed == 0)
+			{
+				break;
+			}
+
+			for (size_t i = 0; i < claimed; ++i)
+			{
+				Cell& cell = mCells[(pos + i) & mMask];
+				std::construct_at(cell.Value(), *first);
+				++first;
+				cell.mSequence.store(pos + i + 1, std::memory_order_release);
+			}
+			enqueued += claimed;
+		}
+
+		if (enqueued > 0)
+		{
+			notify(mItemSignal, mItemWaiters);
+		}
+		return enqueued;
+	}
+
+	bool IsEmpty() const noexcept
+	{
+		return Count() == 0;
+	}
+
+	bool TryDequeue(T& outValue)
+	{
+		size_t pos;
+		if (claim(mDequeuePos, 1, 1, pos) == 0)
+		{
+			return false;
+		}
+
+		Cell& cell = mCells[pos & mMask];
+		outValue = std::move(*cell.Value());
+		std::destroy_at(cell.Value());
+		cell.mSequence.store(pos + mCapacity, std::memory_order_release);
+		notify(mSpaceSignal, mSpaceWaiters);
+		return true;
+	}
+
+	template <typename... Args>
+	bool TryEmplace(Args&&... args)
+	{
+		return TryEnqueue(T(std::forward<Args>(args)...));
+	}
+
+	bool TryEnqueue(const T& value)
+	{
+		return TryEnqueue(T(value));
+	}
+
+	bool TryEnqueue(T&& value)
+	{
+		size_t pos;
+		if (claim(mEnqueuePos, 0, 1, pos) == 0)
+		{
+			return false;
+		}
+
+		Cell& cell = mCells[pos & mMask];
+		std::construct_at(cell.Value(), std::move(value));
+		cell.mSequence.store(pos + 1, std::memory_order_release);
+		notify(mItemSignal, mItemWaiters);
+		return true;
+	}
+
+private:
+	// Claims up to maxCount consecutive positions whose cells are ready, i.e. whose
+	// sequence equals position + offset (0 for producers, 1 for consumers). A ready
+	// cell stays ready until its position is claimed, so checking cells before the
+	// CAS is race-free. Returns the number of positions claimed, starting at outPos.
+	size_t claim(std::atomic<size_t>& position, size_t offset, size_t maxCount, size_t& outPos) noexcept
+	{
+		size_t pos = position.load(std::memory_order_relaxed);
+		for (;;)
+		{
+			size_t ready = 0;
+			while (ready < maxCount)
+			{
+				size_t sequence = mCells[(pos + ready) & mMask].mSequence.load(std::memory_order_acquire);
+				intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos + ready + offset);
+				if (diff != 0)
+				{
+					if (ready == 0 && diff > 0)
+					{
+						// Another thread claimed pos already; reload and retry.
+						ready = SIZE_MAX;
+					}
+					break;
+				}
+				++ready;
+			}
+
+			if (ready == SIZE_MAX)
+			{
+				pos = position.load(std::memory_order_relaxed);
+				continue;
+			}
+
+			if (ready == 0)
+			{
+				return 0;
+			}
+
+			// Sequentially consistent so that notify's waiter check is ordered after it;
+			// on x86 this is the same locked instruction as a relaxed CAS.
+			if (position.compare_exchange_weak(pos, pos + ready, std::memory_order_seq_cst, std::memory_order_relaxed))
+			{
+				outPos = pos;
+				return ready;
+			}
+		}
+	}
+
+	// Whether a producer has claimed a position no consumer has, so an element is
+	// enqueued or about to be. The dequeue position is read first and never passes
+	// the enqueue position.
+	bool itemPending() const noexcept
+	{
+		size_t dequeuePos = mDequeuePos.load(std::memory_order_seq_cst);
+		size_t enqueuePos = mEnqueuePos.load(std::memory_order_seq_cst);
+		return enqueuePos != dequeuePos;
+	}
+
+	// Whether a consumer has claimed a position no producer has reused yet, so a
+	// cell is free or about to be.
+	bool spacePending() const noexcept
+	{
+		size_t enqueuePos = mEnqueuePos.load(std::memory_order_seq_cst);
+		size_t dequeuePos = mDequeuePos.load(std::memory_order_seq_cst);
+		return static_cast<intptr_t>(enqueuePos - dequeuePos) < static_cast<intptr_t>(mCapacity);
+	}
+
+	// A waker claims its position with a seq_cst CAS and then reads the waiter count
+	// with a seq_cst load. A waiter increments the count and then checks pending
+	// with seq_cst loads. Either the waker's read sees the increment and it notifies,
+	// or the waiter sees the claim and keeps retrying instead of parking, so neither
+	// side needs a fence.
+	template <typename Attempt, typename Pending>
+	void waitFor(std::atomic<uint32_t>& signal, std::atomic<uint32_t>& waiters, Attempt attempt, Pending pending)
+	{
+		SpinWait spinWait(mPolicy);
+		for (;;)
+		{
+			if (attempt())
+			{
+				return;
+			}
+
+			if (!spinWait.ShouldPark())
+			{
+				spinWait.SpinOnce();
+				continue;
+			}
+
+			uint32_t observed = signal.load(std::memory_order_acquire);
+			waiters.fetch_add(1, std::memory_order_seq_cst);
+			if (pending())
+			{
+				// The element or cell is being published; retry without parking.
+				waiters.fetch_sub(1, std::memory_order_relaxed);
+				std::this_thread::yield();
+				continue;
+			}
+			signal.wait(observed, std::memory_order_acquire);
+			waiters.fetch_sub(1, std::memory_order_relaxed);
+		}
+	}
+
+	// Called after a claim. The seq_cst load is a plain load on x86.
+	static void notify(std::atomic<uint32_t>& signal, std::atomic<uint32_t>& waiters) noexcept
+	{
+		if (waiters.load(std::memory_order_seq_cst) > 0)
+		{
+			signal.fetch_add(1, std::memory_order_release);
+			signal.notify_all();
+		}
+	}
+
+private:
+	[[no_unique_address]] CellAllocator mAllocator;
+	const size_t mCapacity;
+	const size_t mMask;
+	Cell* const mCells;
+	const WaitPolicy mPolicy;
+
+	alignas(CACHE_LINE_SIZE) std::atomic<size_t> mEnqueuePos;
+	std::atomic<uint32_t> mItemSignal;
+	std::atomic<uint32_t> mItemWaiters;
+
+	alignas(CACHE_LINE_SIZE) std::atomic<size_t> mDequeuePos;
+	std::atomic<uint32_t> mSpaceSignal;
+	std::atomic<uint32_t> mSpaceWaiters;
+};
+
+} // namespace abouttt
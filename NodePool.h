@@ -0,0 +1,291 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace abouttt
+{
+
+// Fixed-size block pool. Blocks are carved out of slabs allocated together and
+// recycled through an intrusive free list. Not thread-safe.
+class NodePool
+{
+public:
+	static constexpr size_t DEFAULT_BLOCKS_PER_SLAB = 64;
+
+public:
+	NodePool(size_t blockSize, size_t blockAlign = alignof(std::max_align_t), size_t blocksPerSlab = DEFAULT_BLOCKS_PER_SLAB)
+		: mBlockAlign(std::max(blockAlign, alignof(FreeBlock)))
+		, mBlockSize(roundUp(std::max(blockSize, sizeof(FreeBlock)), mBlockAlign))
+		, mBlocksPerSlab(std::max<size_t>(blocksPerSlab, 1))
+		, mSlabHeaderSize(roundUp(sizeof(Slab), mBlockAlign))
+		, mFirstSlab(nullptr)
+		, mCurrentSlab(nullptr)
+		, mCursor(nullptr)
+		, mSlabEnd(nullptr)
+		, mFreeList(nullptr)
+		, mLiveCount(0)
+		, mSlabCount(0)
+	{
+	}
+
+	NodePool(const NodePool&) = delete;
+
+	~NodePool()
+	{
+		Release();
+	}
+
+public:
+	NodePool& operator=(const NodePool&) = delete;
+
+public:
+	template <typename T>
+	static std::shared_ptr<NodePool> Create(size_t blocksPerSlab = DEFAULT_BLOCKS_PER_SLAB)
+	{
+		return std::make_shared<NodePool>(sizeof(T), alignof(T), blocksPerSlab);
+	}
+
+public:
+	void* Allocate()
+	{
+		void* block;
+		if (mFreeList)
+		{
+			block = mFreeList;
+			mFreeList = mFreeList->mNext;
+		}
+		else
+		{
+			if (mCursor == mSlabEnd)
+			{
+				nextSlab();
+			}
+			block = mCursor;
+			mCursor += mBlockSize;
+		}
+		++mLiveCount;
+		return block;
+	}
+
+	size_t BlockAlign() const noexcept
+	{
+		return mBlockAlign;
+	}
+
+	size_t BlockSize() const noexcept
+	{
+		return mBlockSize;
+	}
+
+	size_t BlocksPerSlab() const noexcept
+	{
+		return mBlocksPerSlab;
+	}
+
+	void Deallocate(void* block) noexcept
+	{
+		FreeBlock* freeBlock = static_cast<FreeBlock*>(block);
+		freeBlock->mNext = mFreeList;
+		mFreeList = freeBlock;
+		--mLiveCount;
+	}
+
+	bool Fits(size_t size, size_t align) const noexcept
+	{
+		return size <= mBlockSize && align <= mBlockAlign;
+	}
+
+	size_t LiveCount() const noexcept
+	{
+		return mLiveCount;
+	}
+
+	// Frees every slab. All outstanding blocks become invalid.
+	void Release() noexcept
+	{
+		while (mFirstSlab)
+		{
+			Slab* next = mFirstSlab->mNext;
+			::operator delete(mFirstSlab, std::align_val_t(mBlockAlign));
+			mFirstSlab = next;
+		}
+		mCurrentSlab = nullptr;
+		mCursor = nullptr;
+		mSlabEnd = nullptr;
+		mFreeList = nullptr;
+		mLiveCount = 0;
+		mSlabCount = 0;
+	}
+
+	// Marks every block free in O(1) and keeps the slabs for reuse.
+	// All outstanding blocks become invalid.
+	void Reset() noexcept
+	{
+		mCurrentSlab = mFirstSlab;
+		mCursor = mFirstSlab ? slabBegin(mFirstSlab) : nullptr;
+		mSlabEnd = mFirstSlab ? slabEnd(mFirstSlab) : nullptr;
+		mFreeList = nullptr;
+		mLiveCount = 0;
+	}
+
+	size_t SlabCount() const noexcept
+	{
+		return mSlabCount;
+	}
+
+private:
+	struct FreeBlock
+	{
+		FreeBlock* mNext;
+	};
+
+	struct Slab
+	{
+		Slab* mNext;
+	};
+
+private:
+	static constexpr size_t roundUp(size_t value, size_t align) noexcept
+	{
+		return (value + align - 1) / align * align;
+	}
+
+	std::byte* slabBegin(Slab* slab) const noexcept
+	{
+		return reinterpret_cast<std::byte*>(slab) + mSlabHeaderSize;
+	}
+
+	std::byte* slabEnd(Slab* slab) const noexcept
+	{
+		return slabBegin(slab) + mBlockSize * mBlocksPerSlab;
+	}
+
+	void nextSlab()
+	{
+		Slab* slab = mCurrentSlab ? mCurrentSlab->mNext : mFirstSlab;
+		if (!slab)
+		{
+			void* memory = ::operator new(mSlabHeaderSize + mBlockSize * mBlocksPerSlab, std::align_val_t(mBlockAlign));
+			slab = ::new (memory) Slab{ nullptr };
+			if (mCurrentSlab)
+			{
+				mCurrentSlab->mNext = slab;
+			}
+			else
+			{
+				mFirstSlab = slab;
+			}
+			++mSlabCount;
+		}
+		mCurrentSlab = slab;
+		mCursor = slabBegin(slab);
+		mSlabEnd = slabEnd(slab);
+	}
+
+private:
+	size_t mBlockAlign;
+	size_t mBlockSize;
+	size_t mBlocksPerSlab;
+	size_t mSlabHeaderSize;
+	Slab* mFirstSlab;
+	Slab* mCurrentSlab;
+	std::byte* mCursor;
+	std::byte* mSlabEnd;
+	FreeBlock* mFreeList;
+	size_t mLiveCount;
+	size_t mSlabCount;
+};
+
+// Allocator serving single-object allocations from a shared NodePool.
+// Copies and rebound copies share one slot for the pool, and compare equal for
+// as long as they live. A default-constructed allocator leaves the slot empty
+// until the first single-object allocation through any copy fills it with a pool
+// sized for that type, typically a container's node. Array allocations, or types
+// that do not fit the pool's blocks, fall back to std::allocator.
+template <typename T>
+class PoolAllocator
+{
+public:
+	template <typename U>
+	friend class PoolAllocator;
+
+public:
+	using value_type = T;
+	using propagate_on_container_copy_assignment = std::true_type;
+	using propagate_on_container_move_assignment = std::true_type;
+	using propagate_on_container_swap = std::true_type;
+
+public:
+	PoolAllocator()
+		: PoolAllocator(nullptr)
+	{
+	}
+
+	explicit PoolAllocator(std::shared_ptr<NodePool> pool)
+		: mPool(std::make_shared<std::shared_ptr<NodePool>>(std::move(pool)))
+	{
+	}
+
+	// Moving copies, so that the source still equals the result.
+	PoolAllocator(const PoolAllocator& other) noexcept = default;
+
+	template <typename U>
+	PoolAllocator(const PoolAllocator<U>& other) noexcept
+		: mPool(other.mPool)
+	{
+	}
+
+public:
+	template <typename U>
+	bool operator==(const PoolAllocator<U>& other) const noexcept
+	{
+		return mPool == other.mPool;
+	}
+
+public:
+	T* allocate(size_t n)
+	{
+		if (n == 1)
+		{
+			std::shared_ptr<NodePool>& pool = *mPool;
+			if (!pool)
+			{
+				pool = NodePool::Create<T>();
+			}
+			if (pool->Fits(sizeof(T), alignof(T)))
+			{
+				return static_cast<T*>(pool->Allocate());
+			}
+		}
+		return std::allocator<T>().allocate(n);
+	}
+
+	void deallocate(T* ptr, size_t n) noexcept
+	{
+		NodePool* pool = Pool();
+		if (n == 1 && pool && pool->Fits(sizeof(T), alignof(T)))
+		{
+			pool->Deallocate(ptr);
+		}
+		else
+		{
+			std::allocator<T>().deallocate(ptr, n);
+		}
+	}
+
+	NodePool* Pool() const noexcept
+	{
+		return mPool->get();
+	}
+
+private:
+	// Never null; only the pool it holds is filled in lazily.
+	std::shared_ptr<std::shared_ptr<NodePool>> mPool;
+};
+
+} // namespace abouttt
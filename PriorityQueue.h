@@ -1,19 +1,48 @@
 #pragma once
 
 #include <algorithm>
+#include <bit>
 #include <functional>
 #include <initializer_list>
+#include <iterator>
 #include <memory>
 #include <new>
 #include <stdexcept>
+#include <type_traits>
 #include <utility>
 
+#include "Array.h"
+#include "GrowthPolicy.h"
+#include "Instrumentation.h"
+#include "Memory.h"
+
 namespace abouttt
 {
 
-template <typename T, typename Compare = std::less<T>>
+// Selects the PriorityQueue constructor that adopts storage which already holds a heap.
+struct AdoptHeapTag
+{
+	explicit AdoptHeapTag() = default;
+};
+
+inline constexpr AdoptHeapTag ADOPT_HEAP{};
+
+// Arity is the number of children per heap node. Wider heaps are shallower and
+// keep all children of a node in one or two cache lines, which speeds up Dequeue
+// on large heaps at the cost of more comparisons per level.
+template <typename T, typename Compare = std::less<T>, typename Allocator = std::allocator<T>, size_t Arity = 2,
+	typename Growth = DefaultGrowth>
 class PriorityQueue
 {
+	static_assert(std::is_same_v<typename Allocator::value_type, T>, "Allocator::value_type must be T");
+	static_assert(Arity >= 2, "PriorityQueue arity must be at least 2");
+
+private:
+	using AllocatorTraits = std::allocator_traits<Allocator>;
+
+public:
+	using AllocatorType = Allocator;
+
 public:
 	PriorityQueue() noexcept
 		: PriorityQueue(0, Compare())
@@ -25,14 +54,25 @@ public:
 	{
 	}
 
+	explicit PriorityQueue(const Allocator& alloc) noexcept
+		: PriorityQueue(0, Compare(), alloc)
+	{
+	}
+
+	PriorityQueue(const Compare& comp, const Allocator& alloc) noexcept
+		: PriorityQueue(0, comp, alloc)
+	{
+	}
+
 	explicit PriorityQueue(size_t capacity)
 		: PriorityQueue(capacity, Compare())
 	{
 	}
 
-	PriorityQueue(size_t capacity, const Compare& comp)
+	PriorityQueue(size_t capacity, const Compare& comp, const Allocator& alloc = Allocator())
 		: mCompare(comp)
-		, mData(capacity > 0 ? static_cast<T*>(::operator new(sizeof(T) * capacity)) : nullptr)
+		, mAllocator(alloc)
+		, mData(capacity > 0 ? AllocatorTraits::allocate(mAllocator, capacity) : nullptr)
 		, mCount(0)
 		, mCapacity(capacity)
 	{
@@ -43,16 +83,52 @@ public:
 	{
 	}
 
-	PriorityQueue(std::initializer_list<T> ilist, const Compare& comp)
-		: PriorityQueue(ilist.size(), comp)
+	PriorityQueue(std::initializer_list<T> ilist, const Compare& comp, const Allocator& alloc = Allocator())
+		: PriorityQueue(ilist.size(), comp, alloc)
 	{
 		std::uninitialized_copy(ilist.begin(), ilist.end(), mData);
 		mCount = ilist.size();
 		makeHeap();
 	}
 
+	template <std::input_iterator InputIt>
+	PriorityQueue(InputIt first, InputIt last, const Compare& comp = Compare(), const Allocator& alloc = Allocator())
+		: PriorityQueue(comp, alloc)
+	{
+		EnqueueRange(first, last);
+	}
+
+	// Takes the elements of array and heapifies them in O(n).
+	template <typename ArrayGrowth, size_t N>
+	explicit PriorityQueue(Array<T, Allocator, ArrayGrowth, N>&& array, const Compare& comp = Compare())
+		: PriorityQueue(array.Count(), comp, array.GetAllocator())
+	{
+		std::uninitialized_move_n(array.Data(), array.Count(), mData);
+		mCount = array.Count();
+		array.Clear();
+		makeHeap();
+	}
+
+	// Takes ownership of data, storage for capacity elements obtained from alloc,
+	// whose first count elements already form a heap under comp with this Arity.
+	// Nothing is moved or compared.
+	PriorityQueue(AdoptHeapTag, T* data, size_t count, size_t capacity, const Compare& comp = Compare(),
+		const Allocator& alloc = Allocator()) noexcept
+		: mCompare(comp)
+		, mAllocator(alloc)
+		, mData(data)
+		, mCount(count)
+		, mCapacity(capacity)
+	{
+	}
+
 	PriorityQueue(const PriorityQueue& other)
-		: PriorityQueue(other.mCount, other.mCompare)
+		: PriorityQueue(other, AllocatorTraits::select_on_container_copy_construction(other.mAllocator))
+	{
+	}
+
+	PriorityQueue(const PriorityQueue& other, const Allocator& alloc)
+		: PriorityQueue(other.mCount, other.mCompare, alloc)
 	{
 		std::uninitialized_copy(other.mData, other.mData + other.mCount, mData);
 		mCount = other.mCount;
@@ -61,12 +137,29 @@ public:
 
 	PriorityQueue(PriorityQueue&& other) noexcept
 		: mCompare(std::move(other.mCompare))
+		, mAllocator(std::move(other.mAllocator))
 		, mData(std::exchange(other.mData, nullptr))
 		, mCount(std::exchange(other.mCount, 0))
 		, mCapacity(std::exchange(other.mCapacity, 0))
 	{
 	}
 
+	PriorityQueue(PriorityQueue&& other, const Allocator& alloc)
+		: PriorityQueue(other.mCompare, alloc)
+	{
+		if (mAllocator == other.mAllocator)
+		{
+			swapStorage(other);
+		}
+		else
+		{
+			reallocate(other.mCount);
+			std::uninitialized_move_n(other.mData, other.mCount, mData);
+			mCount = other.mCount;
+			other.Clear();
+		}
+	}
+
 	~PriorityQueue()
 	{
 		cleanup();
@@ -77,29 +170,48 @@ public:
 	{
 		if (this != &other)
 		{
-			PriorityQueue temp(other);
-			Swap(temp);
+			if constexpr (AllocatorTraits::propagate_on_container_copy_assignment::value)
+			{
+				if (mAllocator != other.mAllocator)
+				{
+					cleanup();
+				}
+				mAllocator = other.mAllocator;
+			}
+			PriorityQueue temp(other, mAllocator);
+			std::swap(mCompare, temp.mCompare);
+			swapStorage(temp);
 		}
 		return *this;
 	}
 
-	PriorityQueue& operator=(PriorityQueue&& other) noexcept
+	PriorityQueue& operator=(PriorityQueue&& other) noexcept(
+		AllocatorTraits::propagate_on_container_move_assignment::value ||
+		AllocatorTraits::is_always_equal::value)
 	{
 		if (this != &other)
 		{
-			cleanup();
-			mCompare = std::move(other.mCompare);
-			mData = std::exchange(other.mData, nullptr);
-			mCount = std::exchange(other.mCount, 0);
-			mCapacity = std::exchange(other.mCapacity, 0);
+			if constexpr (AllocatorTraits::propagate_on_container_move_assignment::value)
+			{
+				cleanup();
+				mCompare = std::move(other.mCompare);
+				mAllocator = std::move(other.mAllocator);
+				swapStorage(other);
+			}
+			else
+			{
+				PriorityQueue temp(std::move(other), mAllocator);
+				std::swap(mCompare, temp.mCompare);
+				swapStorage(temp);
+			}
 		}
 		return *this;
 	}
 
 	PriorityQueue& operator=(std::initializer_list<T> ilist)
 	{
-		PriorityQueue temp(ilist);
-		Swap(temp);
+		PriorityQueue temp(ilist, mCompare, mAllocator);
+		swapStorage(temp);
 		return *this;
 	}
 
@@ -115,16 +227,16 @@ public:
 		return mCount;
 	}
 
+	// The elements in heap order; Data()[0] is the top.
+	const T* Data() const noexcept
+	{
+		return mData;
+	}
+
 	void Dequeue()
 	{
 		checkEmpty();
-		std::swap(mData[0], mData[mCount - 1]);
-		std::destroy_at(mData + mCount - 1);
-		--mCount;
-		if (mCount > 0)
-		{
-			heapifyDown(0);
-		}
+		removeTop();
 	}
 
 	template <typename... Args>
@@ -146,17 +258,101 @@ public:
 		Emplace(std::move(value));
 	}
 
+	// Appends the elements and restores the heap either by sifting each one up or,
+	// when that would cost more, by rebuilding the whole heap in O(n).
+	template <std::input_iterator InputIt>
+	void EnqueueRange(InputIt first, InputIt last)
+	{
+		size_t oldCount = mCount;
+		if constexpr (std::forward_iterator<InputIt>)
+		{
+			ensureCapacity(mCount + static_cast<size_t>(std::distance(first, last)));
+		}
+
+		// Whatever was appended before a throw is still heapified, so the queue
+		// stays ordered.
+		try
+		{
+			for (; first != last; ++first)
+			{
+				ensureCapacity(mCount + 1);
+				std::construct_at(mData + mCount, *first);
+				++mCount;
+			}
+		}
+		catch (...)
+		{
+			restoreHeap(oldCount);
+			throw;
+		}
+		restoreHeap(oldCount);
+	}
+
+	Allocator GetAllocator() const noexcept
+	{
+		return mAllocator;
+	}
+
 	bool IsEmpty() const noexcept
 	{
 		return mCount == 0;
 	}
 
+	// Moves every element of other into this queue, leaving other empty. If other is
+	// the larger heap and the allocators are equal, its buffer is adopted and this
+	// queue's elements are merged into it.
+	void Merge(PriorityQueue&& other)
+	{
+		if (this == &other)
+		{
+			return;
+		}
+
+		if (other.mCount > mCount && mAllocator == other.mAllocator)
+		{
+			swapStorage(other);
+		}
+
+		ensureCapacity(mCount + other.mCount);
+		size_t oldCount = mCount;
+		if (other.mCount > 0)
+		{
+			RelocateN(other.mData, other.mCount, mData + mCount);
+			mCount += other.mCount;
+			other.mCount = 0;
+		}
+		restoreHeap(oldCount);
+	}
+
 	const T& Peek() const
 	{
 		checkEmpty();
 		return mData[0];
 	}
 
+	T Pop()
+	{
+		checkEmpty();
+		T value = std::move(mData[0]);
+		removeTop();
+		return value;
+	}
+
+	// Pops up to count elements, highest priority first, into out and returns how
+	// many were popped.
+	template <typename OutputIt>
+	size_t PopN(size_t count, OutputIt out)
+	{
+		size_t popped = std::min(count, mCount);
+		for (size_t i = 0; i < popped; ++i)
+		{
+			*out = std::move(mData[0]);
+			++out;
+			removeTop();
+		}
+		return popped;
+	}
+
 	void Reserve(size_t newCapacity)
 	{
 		if (newCapacity > mCapacity)
@@ -176,9 +372,22 @@ public:
 	void Swap(PriorityQueue& other) noexcept
 	{
 		std::swap(mCompare, other.mCompare);
-		std::swap(mData, other.mData);
-		std::swap(mCount, other.mCount);
-		std::swap(mCapacity, other.mCapacity);
+		if constexpr (AllocatorTraits::propagate_on_container_swap::value)
+		{
+			std::swap(mAllocator, other.mAllocator);
+		}
+		swapStorage(other);
+	}
+
+	bool TryPop(T& outValue)
+	{
+		if (mCount == 0)
+		{
+			return false;
+		}
+		outValue = std::move(mData[0]);
+		removeTop();
+		return true;
 	}
 
 private:
@@ -194,40 +403,46 @@ private:
 	{
 		if (minCapacity > mCapacity)
 		{
-			size_t grow = mCapacity + (mCapacity >> 1); // Grow by 1.5x
-			size_t newCapacity = std::max(minCapacity, mCapacity == 0 ? 8 : grow);
-			reallocate(newCapacity);
+			reallocate(Growth::Grow(mCapacity, minCapacity, sizeof(T)));
 		}
 	}
 
 	void heapifyUp(size_t index)
 	{
 		T value = std::move(mData[index]);
+		[[maybe_unused]] size_t levels = 0;
 
 		while (index > 0)
 		{
-			size_t parent = (index - 1) / 2;
+			size_t parent = (index - 1) / Arity;
 			if (!mCompare(mData[parent], value))
 			{
 				break;
 			}
 			mData[index] = std::move(mData[parent]);
 			index = parent;
+			++levels;
 		}
 
 		mData[index] = std::move(value);
+		ABOUTTT_INSTRUMENT(Heapify, "PriorityQueue", this, sizeof(T) * levels, levels);
 	}
 
 	void heapifyDown(size_t index)
 	{
 		T temp = std::move(mData[index]);
 		size_t child;
+		[[maybe_unused]] size_t levels = 0;
 
-		while ((child = index * 2 + 1) < mCount)
+		while ((child = index * Arity + 1) < mCount)
 		{
-			if (child + 1 < mCount && mCompare(mData[child], mData[child + 1]))
+			size_t last = std::min(child + Arity, mCount);
+			for (size_t sibling = child + 1; sibling < last; ++sibling)
 			{
-				++child;
+				if (mCompare(mData[child], mData[sibling]))
+				{
+					child = sibling;
+				}
 			}
 
 			if (!mCompare(temp, mData[child]))
@@ -237,9 +452,11 @@ private:
 
 			mData[index] = std::move(mData[child]);
 			index = child;
+			++levels;
 		}
 
 		mData[index] = std::move(temp);
+		ABOUTTT_INSTRUMENT(Heapify, "PriorityQueue", this, sizeof(T) * levels, levels);
 	}
 
 	void makeHeap()
@@ -249,12 +466,36 @@ private:
 			return;
 		}
 
-		for (size_t i = mCount / 2; i-- > 0;)
+		for (size_t i = (mCount - 2) / Arity + 1; i-- > 0;)
 		{
 			heapifyDown(i);
 		}
 	}
 
+	// Restores the heap property after elements were appended past heapCount.
+	void restoreHeap(size_t heapCount)
+	{
+		size_t added = mCount - heapCount;
+		if (added == 0)
+		{
+			return;
+		}
+
+		// Sifting each element up costs about added * log(count) comparisons,
+		// rebuilding about 2 * count.
+		if (added * std::bit_width(mCount) > 2 * mCount)
+		{
+			makeHeap();
+		}
+		else
+		{
+			for (size_t i = heapCount; i < mCount; ++i)
+			{
+				heapifyUp(i);
+			}
+		}
+	}
+
 	void reallocate(size_t newCapacity)
 	{
 		if (newCapacity == mCapacity)
@@ -268,27 +509,51 @@ private:
 			return;
 		}
 
-		T* newData = static_cast<T*>(::operator new(sizeof(T) * newCapacity));
+		T* newData = AllocatorTraits::allocate(mAllocator, newCapacity);
 		size_t newCount = std::min(mCount, newCapacity);
 
 		if (mData)
 		{
-			std::uninitialized_move_n(mData, newCount, newData);
-			std::destroy_n(mData, mCount);
-			::operator delete(mData);
+			RelocateN(mData, newCount, newData);
+			std::destroy_n(mData + newCount, mCount - newCount);
+			AllocatorTraits::deallocate(mAllocator, mData, mCapacity);
 		}
+		RecordReallocation<Growth>(sizeof(T) * mCapacity, sizeof(T) * newCapacity, sizeof(T) * newCount, sizeof(T) * newCount);
+		ABOUTTT_INSTRUMENT(Reallocate, "PriorityQueue", this, sizeof(T) * newCount, sizeof(T) * newCapacity);
 
 		mData = newData;
 		mCount = newCount;
 		mCapacity = newCapacity;
 	}
 
+	// Replaces the root, which may be moved-from, with the last element.
+	void removeTop()
+	{
+		--mCount;
+		if (mCount > 0)
+		{
+			mData[0] = std::move(mData[mCount]);
+		}
+		std::destroy_at(mData + mCount);
+		if (mCount > 1)
+		{
+			heapifyDown(0);
+		}
+	}
+
+	void swapStorage(PriorityQueue& other) noexcept
+	{
+		std::swap(mData, other.mData);
+		std::swap(mCount, other.mCount);
+		std::swap(mCapacity, other.mCapacity);
+	}
+
 	void cleanup() noexcept
 	{
 		if (mData)
 		{
 			std::destroy_n(mData, mCount);
-			::operator delete(mData);
+			AllocatorTraits::deallocate(mAllocator, mData, mCapacity);
 			mData = nullptr;
 			mCount = 0;
 			mCapacity = 0;
@@ -297,6 +562,7 @@ private:
 
 private:
 	Compare mCompare;
+	[[no_unique_address]] Allocator mAllocator;
 	T* mData;
 	size_t mCount;
 	size_t mCapacity;
@@ -1,35 +1,59 @@
 #pragma once
 
+#include <algorithm>
+#include <bit>
 #include <compare>
 #include <initializer_list>
 #include <memory>
 #include <new>
 #include <stdexcept>
+#include <type_traits>
 #include <utility>
 
+#include "ArrayView.h"
+#include "GrowthPolicy.h"
+#include "Instrumentation.h"
+#include "Memory.h"
+
 namespace abouttt
 {
 
-template <typename T>
+// With bPowerOfTwo set, capacity is always a power of two and ring indices wrap
+// with a mask instead of a compare.
+template <typename T, typename Allocator = std::allocator<T>, bool bPowerOfTwo = false, typename Growth = DefaultGrowth>
 class Queue
 {
+	static_assert(std::is_same_v<typename Allocator::value_type, T>, "Allocator::value_type must be T");
+
+private:
+	using AllocatorTraits = std::allocator_traits<Allocator>;
+
+public:
+	using AllocatorType = Allocator;
+
 public:
 	Queue() noexcept
 		: Queue(0)
 	{
 	}
 
-	explicit Queue(size_t capacity)
-		: mData(capacity > 0 ? static_cast<T*>(::operator new(sizeof(T) * capacity)) : nullptr)
+	explicit Queue(const Allocator& alloc) noexcept
+		: Queue(0, alloc)
+	{
+	}
+
+	explicit Queue(size_t capacity, const Allocator& alloc = Allocator())
+		: mAllocator(alloc)
+		, mData(capacity > 0 ? AllocatorTraits::allocate(mAllocator, roundCapacity(capacity)) : nullptr)
 		, mFront(0)
 		, mRear(0)
 		, mCount(0)
-		, mCapacity(capacity)
+		, mCapacity(roundCapacity(capacity))
 	{
 	}
 
-	Queue(std::initializer_list<T> ilist)
-		: Queue(ilist.size())
+	Queue(std::initializer_list<T> ilist, const Allocator& alloc = Allocator())
+		: Queue(ilist.size(), alloc)
 	{
 		std::uninitialized_copy(ilist.begin(), ilist.end(), mData);
 		mCount = ilist.size();
@@ -37,7 +61,12 @@ public:
 	}
 
 	Queue(const Queue& other)
-		: Queue(other.mCount)
+		: Queue(other, AllocatorTraits::select_on_container_copy_construction(other.mAllocator))
+	{
+	}
+
+	Queue(const Queue& other, const Allocator& alloc)
+		: Queue(other.mCount, alloc)
 	{
 		copyCircular(other, mData);
 		mCount = other.mCount;
@@ -45,7 +74,8 @@ public:
 	}
 
 	Queue(Queue&& other) noexcept
-		: mData(std::exchange(other.mData, nullptr))
+		: mAllocator(std::move(other.mAllocator))
+		, mData(std::exchange(other.mData, nullptr))
 		, mFront(std::exchange(other.mFront, 0))
 		, mRear(std::exchange(other.mRear, 0))
 		, mCount(std::exchange(other.mCount, 0))
@@ -53,6 +83,23 @@ public:
 	{
 	}
 
+	Queue(Queue&& other, const Allocator& alloc)
+		: Queue(alloc)
+	{
+		if (mAllocator == other.mAllocator)
+		{
+			swapStorage(other);
+		}
+		else
+		{
+			reallocate(other.mCount);
+			other.moveCircular(mData, other.mCount);
+			mCount = other.mCount;
+			mRear = (mCount == mCapacity) ? 0 : mCount;
+			other.Clear();
+		}
+	}
+
 	~Queue()
 	{
 		cleanup();
@@ -63,30 +110,45 @@ public:
 	{
 		if (this != &other)
 		{
-			Queue temp(other);
-			Swap(temp);
+			if constexpr (AllocatorTraits::propagate_on_container_copy_assignment::value)
+			{
+				if (mAllocator != other.mAllocator)
+				{
+					cleanup();
+				}
+				mAllocator = other.mAllocator;
+			}
+			Queue temp(other, mAllocator);
+			swapStorage(temp);
 		}
 		return *this;
 	}
 
-	Queue& operator=(Queue&& other) noexcept
+	Queue& operator=(Queue&& other) noexcept(
+		AllocatorTraits::propagate_on_container_move_assignment::value ||
+		AllocatorTraits::is_always_equal::value)
 	{
 		if (this != &other)
 		{
-			cleanup();
-			mData = std::exchange(other.mData, nullptr);
-			mFront = std::exchange(other.mFront, 0);
-			mRear = std::exchange(other.mRear, 0);
-			mCount = std::exchange(other.mCount, 0);
-			mCapacity = std::exchange(other.mCapacity, 0);
+			if constexpr (AllocatorTraits::propagate_on_container_move_assignment::value)
+			{
+				cleanup();
+				mAllocator = std::move(other.mAllocator);
+				swapStorage(other);
+			}
+			else
+			{
+				Queue temp(std::move(other), mAllocator);
+				swapStorage(temp);
+			}
 		}
 		return *this;
 	}
 
 	Queue& operator=(std::initializer_list<T> ilist)
 	{
-		Queue temp(ilist);
-		Swap(temp);
+		Queue temp(ilist, mAllocator);
+		swapStorage(temp);
 		return *this;
 	}
 
@@ -99,8 +161,8 @@ public:
 
 		for (size_t i = 0; i < mCount; ++i)
 		{
-			const T& a = mData[(mFront + i) % mCapacity];
-			const T& b = other.mData[(other.mFront + i) % other.mCapacity];
+			const T& a = mData[wrap(mFront + i)];
+			const T& b = other.mData[other.wrap(other.mFront + i)];
 			if (auto cmp = a <=> b; cmp != 0)
 			{
 				return cmp;
@@ -119,7 +181,7 @@ public:
 
 		for (size_t i = 0; i < mCount; ++i)
 		{
-			if (mData[(mFront + i) % mCapacity] != other.mData[(other.mFront + i) % other.mCapacity])
+			if (mData[wrap(mFront + i)] != other.mData[other.wrap(other.mFront + i)])
 			{
 				return false;
 			}
@@ -129,6 +191,11 @@ public:
 	}
 
 public:
+	size_t Capacity() const noexcept
+	{
+		return mCapacity;
+	}
+
 	void Clear() noexcept
 	{
 		destroyCircular();
@@ -139,14 +206,8 @@ public:
 
 	bool Contains(const T& value) const
 	{
-		for (size_t i = 0; i < mCount; ++i)
-		{
-			if (mData[(mFront + i) % mCapacity] == value)
-			{
-				return true;
-			}
-		}
-		return false;
+		auto [front, back] = Segments();
+		return front.Contains(value) || back.Contains(value);
 	}
 
 	size_t Count() const noexcept
@@ -158,7 +219,7 @@ public:
 	{
 		checkEmpty();
 		std::destroy_at(mData + mFront);
-		mFront = (mFront + 1) % mCapacity;
+		mFront = advance(mFront);
 		--mCount;
 	}
 
@@ -167,7 +228,7 @@ public:
 	{
 		ensureCapacity(mCount + 1);
 		std::construct_at(mData + mRear, std::forward<Args>(args)...);
-		mRear = (mRear + 1) % mCapacity;
+		mRear = advance(mRear);
 		++mCount;
 	}
 
@@ -181,6 +242,11 @@ public:
 		Emplace(std::move(value));
 	}
 
+	Allocator GetAllocator() const noexcept
+	{
+		return mAllocator;
+	}
+
 	bool IsEmpty() const noexcept
 	{
 		return mCount == 0;
@@ -198,6 +264,25 @@ public:
 		return mData[mFront];
 	}
 
+	T Pop()
+	{
+		checkEmpty();
+		return popFront();
+	}
+
+	// Pops up to count elements, front first, into out and returns how many were popped.
+	template <typename OutputIt>
+	size_t PopN(size_t count, OutputIt out)
+	{
+		size_t popped = std::min(count, mCount);
+		for (size_t i = 0; i < popped; ++i)
+		{
+			*out = popFront();
+			++out;
+		}
+		return popped;
+	}
+
 	void Reserve(size_t newCapacity)
 	{
 		if (newCapacity > mCapacity)
@@ -206,6 +291,15 @@ public:
 		}
 	}
 
+	// The elements front first, as the run up to the end of the ring followed by the
+	// wrapped-around run, which is empty unless the queue wraps. Valid until the
+	// queue is next modified.
+	std::pair<ArrayView<const T>, ArrayView<const T>> Segments() const noexcept
+	{
+		size_t frontPartSize = std::min(mCount, mCapacity - mFront);
+		return { ArrayView<const T>(mData + mFront, frontPartSize), ArrayView<const T>(mData, mCount - frontPartSize) };
+	}
+
 	void Shrink()
 	{
 		if (mCapacity > mCount)
@@ -216,11 +310,21 @@ public:
 
 	void Swap(Queue& other) noexcept
 	{
-		std::swap(mData, other.mData);
-		std::swap(mFront, other.mFront);
-		std::swap(mRear, other.mRear);
-		std::swap(mCount, other.mCount);
-		std::swap(mCapacity, other.mCapacity);
+		if constexpr (AllocatorTraits::propagate_on_container_swap::value)
+		{
+			std::swap(mAllocator, other.mAllocator);
+		}
+		swapStorage(other);
+	}
+
+	bool TryPop(T& outValue)
+	{
+		if (mCount == 0)
+		{
+			return false;
+		}
+		outValue = popFront();
+		return true;
 	}
 
 private:
@@ -236,12 +340,19 @@ private:
 	{
 		if (minCapacity > mCapacity)
 		{
-			size_t grow = mCapacity + (mCapacity >> 1); // Grow by 1.5x
-			size_t newCapacity = std::max(minCapacity, mCapacity == 0 ? 8 : grow);
-			reallocate(newCapacity);
+			reallocate(Growth::Grow(mCapacity, minCapacity, sizeof(T)));
 		}
 	}
 
+	T popFront()
+	{
+		T value = std::move(mData[mFront]);
+		std::destroy_at(mData + mFront);
+		mFront = advance(mFront);
+		--mCount;
+		return value;
+	}
+
 	void reallocate(size_t newCapacity)
 	{
 		if (newCapacity == mCapacity)
@@ -255,15 +366,30 @@ private:
 			return;
 		}
 
-		T* newData = static_cast<T*>(::operator new(sizeof(T) * newCapacity));
+		newCapacity = roundCapacity(newCapacity);
+		if (newCapacity == mCapacity)
+		{
+			return;
+		}
+
+		T* newData = AllocatorTraits::allocate(mAllocator, newCapacity);
 		size_t newCount = std::min(mCount, newCapacity);
 
 		if (mData)
 		{
-			moveCircular(newData, newCount);
-			destroyCircular();
-			::operator delete(mData);
+			if constexpr (IsTriviallyRelocatableV<T>)
+			{
+				relocateCircular(newData, newCount);
+			}
+			else
+			{
+				moveCircular(newData, newCount);
+				destroyCircular();
+			}
+			AllocatorTraits::deallocate(mAllocator, mData, mCapacity);
 		}
+		RecordReallocation<Growth>(sizeof(T) * mCapacity, sizeof(T) * newCapacity, sizeof(T) * newCount, sizeof(T) * newCount);
+		ABOUTTT_INSTRUMENT(Reallocate, "Queue", this, sizeof(T) * newCount, sizeof(T) * newCapacity);
 
 		mData = newData;
 		mFront = 0;
@@ -272,6 +398,42 @@ private:
 		mRear = (mCount == mCapacity) ? 0 : mCount;
 	}
 
+	static size_t roundCapacity(size_t capacity) noexcept
+	{
+		if constexpr (bPowerOfTwo)
+		{
+			return capacity > 0 ? std::bit_ceil(capacity) : 0;
+		}
+		else
+		{
+			return capacity;
+		}
+	}
+
+	// Wraps an index in [0, 2 * mCapacity) back into the ring.
+	size_t wrap(size_t index) const noexcept
+	{
+		if constexpr (bPowerOfTwo)
+		{
+			return index & (mCapacity - 1);
+		}
+		else
+		{
+			return index >= mCapacity ? index - mCapacity : index;
+		}
+	}
+
+	// The slot after index, reporting when the ring wraps around to slot 0.
+	size_t advance(size_t index) const noexcept
+	{
+		size_t next = wrap(index + 1);
+		if (next == 0)
+		{
+			ABOUTTT_INSTRUMENT(WrapAround, "Queue", this, 0, mCapacity);
+		}
+		return next;
+	}
+
 	void destroyCircular() noexcept
 	{
 		if (!mData)
@@ -336,12 +498,33 @@ private:
 		}
 	}
 
+	void relocateCircular(T* to, size_t count) noexcept
+	{
+		size_t frontPartSize = std::min(count, mCapacity - mFront);
+		RelocateN(mData + mFront, frontPartSize, to);
+		RelocateN(mData, count - frontPartSize, to + frontPartSize);
+
+		for (size_t i = count; i < mCount; ++i)
+		{
+			std::destroy_at(mData + wrap(mFront + i));
+		}
+	}
+
+	void swapStorage(Queue& other) noexcept
+	{
+		std::swap(mData, other.mData);
+		std::swap(mFront, other.mFront);
+		std::swap(mRear, other.mRear);
+		std::swap(mCount, other.mCount);
+		std::swap(mCapacity, other.mCapacity);
+	}
+
 	void cleanup() noexcept
 	{
 		if (mData)
 		{
 			destroyCircular();
-			::operator delete(mData);
+			AllocatorTraits::deallocate(mAllocator, mData, mCapacity);
 			mData = nullptr;
 			mFront = 0;
 			mRear = 0;
@@ -351,6 +534,7 @@ private:
 	}
 
 private:
+	[[no_unique_address]] Allocator mAllocator;
 	T* mData;
 	size_t mFront;
 	size_t mRear;
@@ -358,4 +542,7 @@ private:
 	size_t mCapacity;
 };
 
+template <typename T, typename Allocator = std::allocator<T>, typename Growth = DefaultGrowth>
+using PowerOfTwoQueue = Queue<T, Allocator, true, Growth>;
+
 } // namespace abouttt
@@ -0,0 +1,248 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "Array.h"
+
+namespace abouttt
+{
+
+// Monotone min-priority queue for unsigned integer keys (radix heap). Elements are
+// bucketed by the highest bit in which their key differs from the last dequeued
+// key, so Enqueue is O(1) and Dequeue is amortized O(log C), where C is the key
+// range, without comparing elements against each other.
+//
+// Keys must not be less than the key of the last dequeued element; this holds for
+// timers and for Dijkstra with non-negative edge weights. Elements with equal
+// keys are dequeued in no particular order.
+template <typename Key, typename Value, typename Allocator = std::allocator<Value>>
+class RadixPriorityQueue
+{
+	static_assert(std::is_integral_v<Key> && std::is_unsigned_v<Key>, "RadixPriorityQueue keys must be unsigned integers");
+	static_assert(std::is_same_v<typename Allocator::value_type, Value>, "Allocator::value_type must be Value");
+
+private:
+	struct Entry
+	{
+		template <typename... Args>
+		explicit Entry(Key key, Args&&... args)
+			: mKey(key)
+			, mValue(std::forward<Args>(args)...)
+		{
+		}
+
+		Key mKey;
+		Value mValue;
+	};
+
+	using EntryAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Entry>;
+	using Bucket = Array<Entry, EntryAllocator>;
+
+	// Bucket 0 holds keys equal to mLast; bucket i holds keys whose highest bit
+	// differing from mLast is bit i - 1.
+	static constexpr size_t BUCKET_COUNT = std::numeric_limits<Key>::digits + 1;
+
+public:
+	using AllocatorType = Allocator;
+
+public:
+	RadixPriorityQueue()
+		: RadixPriorityQueue(Allocator())
+	{
+	}
+
+	explicit RadixPriorityQueue(const Allocator& alloc)
+		: mBuckets(makeBuckets(EntryAllocator(alloc), std::make_index_sequence<BUCKET_COUNT>()))
+		, mLast(0)
+		, mCount(0)
+	{
+	}
+
+public:
+	void Clear() noexcept
+	{
+		for (Bucket& bucket : mBuckets)
+		{
+			bucket.Clear();
+		}
+		mLast = 0;
+		mCount = 0;
+	}
+
+	size_t Count() const noexcept
+	{
+		return mCount;
+	}
+
+	void Dequeue()
+	{
+		checkEmpty();
+		Bucket& bucket = topBucket();
+		bucket.RemoveAt(bucket.Count() - 1);
+		--mCount;
+	}
+
+	template <typename... Args>
+	void Emplace(Key key, Args&&... args)
+	{
+		if (key < mLast)
+		{
+			throw std::out_of_range("Key is less than the last dequeued key");
+		}
+		mBuckets[bucketIndex(key)].Emplace(key, std::forward<Args>(args)...);
+		++mCount;
+	}
+
+	void Enqueue(Key key, const Value& value)
+	{
+		Emplace(key, value);
+	}
+
+	void Enqueue(Key key, Value&& value)
+	{
+		Emplace(key, std::move(value));
+	}
+
+	Allocator GetAllocator() const noexcept
+	{
+		return Allocator(mBuckets[0].GetAllocator());
+	}
+
+	bool IsEmpty() const noexcept
+	{
+		return mCount == 0;
+	}
+
+	// Key of the last dequeued element, below which no key may be enqueued.
+	Key LastKey() const noexcept
+	{
+		return mLast;
+	}
+
+	// O(1) after a Dequeue of an element with an equal key; otherwise scans the
+	// lowest non-empty bucket.
+	const Value& Peek() const
+	{
+		return peekEntry().mValue;
+	}
+
+	Key PeekKey() const
+	{
+		return peekEntry().mKey;
+	}
+
+	Value Pop()
+	{
+		checkEmpty();
+		Bucket& bucket = topBucket();
+		Value value = std::move(bucket.GetUnchecked(bucket.Count() - 1).mValue);
+		bucket.RemoveAt(bucket.Count() - 1);
+		--mCount;
+		return value;
+	}
+
+	void Swap(RadixPriorityQueue& other) noexcept
+	{
+		for (size_t i = 0; i < BUCKET_COUNT; ++i)
+		{
+			mBuckets[i].Swap(other.mBuckets[i]);
+		}
+		std::swap(mLast, other.mLast);
+		std::swap(mCount, other.mCount);
+	}
+
+	bool TryPop(Value& outValue)
+	{
+		if (mCount == 0)
+		{
+			return false;
+		}
+		outValue = Pop();
+		return true;
+	}
+
+private:
+	template <size_t... Indices>
+	static std::array<Bucket, BUCKET_COUNT> makeBuckets(const EntryAllocator& alloc, std::index_sequence<Indices...>)
+	{
+		return { { ((void)Indices, Bucket(alloc))... } };
+	}
+
+	size_t bucketIndex(Key key) const noexcept
+	{
+		return static_cast<size_t>(std::bit_width(static_cast<Key>(key ^ mLast)));
+	}
+
+	void checkEmpty() const
+	{
+		if (mCount == 0)
+		{
+			throw std::out_of_range("Priority queue is empty");
+		}
+	}
+
+	size_t lowestBucket() const noexcept
+	{
+		size_t index = 0;
+		while (mBuckets[index].IsEmpty())
+		{
+			++index;
+		}
+		return index;
+	}
+
+	// Picks the last of several minimal keys, which is the one that ends up on top of
+	// bucket 0 after topBucket() redistributes, so Peek and Pop agree.
+	static size_t minIndex(const Bucket& bucket) noexcept
+	{
+		size_t best = 0;
+		for (size_t i = 1; i < bucket.Count(); ++i)
+		{
+			if (bucket.GetUnchecked(i).mKey <= bucket.GetUnchecked(best).mKey)
+			{
+				best = i;
+			}
+		}
+		return best;
+	}
+
+	const Entry& peekEntry() const
+	{
+		checkEmpty();
+		size_t index = lowestBucket();
+		const Bucket& bucket = mBuckets[index];
+		return bucket.GetUnchecked(index == 0 ? bucket.Count() - 1 : minIndex(bucket));
+	}
+
+	// Returns bucket 0 after making the minimum key the new mLast and redistributing
+	// the lowest non-empty bucket, whose keys all land in lower buckets.
+	Bucket& topBucket()
+	{
+		size_t index = lowestBucket();
+		if (index > 0)
+		{
+			Bucket& source = mBuckets[index];
+			mLast = source.GetUnchecked(minIndex(source)).mKey;
+			for (Entry& entry : source)
+			{
+				mBuckets[bucketIndex(entry.mKey)].Add(std::move(entry));
+			}
+			source.Clear();
+		}
+		return mBuckets[0];
+	}
+
+private:
+	std::array<Bucket, BUCKET_COUNT> mBuckets;
+	Key mLast;
+	size_t mCount;
+};
+
+} // namespace abouttt
@@ -0,0 +1,540 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// Vectorized searches are used for arithmetic, enum and pointer elements when this
+// is non-zero. AVX2 and AVX-512 kernels are selected at runtime on x86 with GCC or
+// Clang; SSE2 and NEON are used whenever the target guarantees them.
+#ifndef ABOUTTT_SIMD
+#define ABOUTTT_SIMD 1
+#endif
+
+#if ABOUTTT_SIMD && (defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__))
+#include <immintrin.h>
+#define ABOUTTT_SIMD_SSE2 1
+#if defined(__GNUC__) || defined(__clang__)
+#define ABOUTTT_SIMD_AVX 1
+#endif
+#elif ABOUTTT_SIMD && defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define ABOUTTT_SIMD_NEON 1
+#endif
+
+namespace abouttt
+{
+
+// Element types whose equality is a lane-wise integer or IEEE compare.
+template <typename T>
+inline constexpr bool IsSimdSearchableV =
+	(std::is_arithmetic_v<T> || std::is_enum_v<T> || std::is_pointer_v<T>) &&
+	(std::is_floating_point_v<T> ? (sizeof(T) == 4 || sizeof(T) == 8) :
+		(sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8));
+
+enum class SimdLevel
+{
+	Scalar,
+	Sse2,
+	Avx2,
+	Avx512,
+	Neon,
+};
+
+// The widest instruction set the search kernels can use on this machine.
+inline SimdLevel DetectSimdLevel() noexcept
+{
+#if defined(ABOUTTT_SIMD_AVX)
+	static const SimdLevel level = []
+	{
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw"))
+		{
+			return SimdLevel::Avx512;
+		}
+		if (__builtin_cpu_supports("avx2"))
+		{
+			return SimdLevel::Avx2;
+		}
+		return SimdLevel::Sse2;
+	}();
+	return level;
+#elif defined(ABOUTTT_SIMD_SSE2)
+	return SimdLevel::Sse2;
+#elif defined(ABOUTTT_SIMD_NEON)
+	return SimdLevel::Neon;
+#else
+	return SimdLevel::Scalar;
+#endif
+}
+
+// Linear searches over contiguous memory, comparing a whole vector register per
+// step. Both return count when no element equals value. Floating-point elements
+// follow operator==: NaN matches nothing and -0.0 matches 0.0.
+class SimdSearch
+{
+public:
+	template <typename T>
+	static size_t Find(const T* data, size_t count, const T& value) noexcept
+	{
+		static_assert(IsSimdSearchableV<T>, "T is not searchable with SIMD");
+#if defined(ABOUTTT_SIMD_AVX)
+		SimdLevel level = DetectSimdLevel();
+		if (level == SimdLevel::Avx512 && count >= 64 / sizeof(T))
+		{
+			return findAvx512(data, count, value);
+		}
+		if ((level == SimdLevel::Avx2 || level == SimdLevel::Avx512) && count >= 32 / sizeof(T))
+		{
+			return findAvx2(data, count, value);
+		}
+#endif
+#if defined(ABOUTTT_SIMD_SSE2)
+		return findSse2(data, count, value);
+#elif defined(ABOUTTT_SIMD_NEON)
+		return findNeon(data, count, value);
+#else
+		return findScalar(data, 0, count, value);
+#endif
+	}
+
+	template <typename T>
+	static size_t FindLast(const T* data, size_t count, const T& value) noexcept
+	{
+		static_assert(IsSimdSearchableV<T>, "T is not searchable with SIMD");
+#if defined(ABOUTTT_SIMD_AVX)
+		SimdLevel level = DetectSimdLevel();
+		if (level == SimdLevel::Avx512 && count >= 64 / sizeof(T))
+		{
+			return findLastAvx512(data, count, value);
+		}
+		if ((level == SimdLevel::Avx2 || level == SimdLevel::Avx512) && count >= 32 / sizeof(T))
+		{
+			return findLastAvx2(data, count, value);
+		}
+#endif
+#if defined(ABOUTTT_SIMD_SSE2)
+		return findLastSse2(data, count, value);
+#elif defined(ABOUTTT_SIMD_NEON)
+		return findLastNeon(data, count, value);
+#else
+		return findLastScalar(data, count, count, value);
+#endif
+	}
+
+private:
+	// Searches [first, last); returns count when nothing matches.
+	template <typename T>
+	static size_t findScalar(const T* data, size_t first, size_t count, const T& value) noexcept
+	{
+		for (size_t i = first; i < count; ++i)
+		{
+			if (data[i] == value)
+			{
+				return i;
+			}
+		}
+		return count;
+	}
+
+	// Searches [0, last) backwards; returns count when nothing matches.
+	template <typename T>
+	static size_t findLastScalar(const T* data, size_t last, size_t count, const T& value) noexcept
+	{
+		for (size_t i = last; i-- > 0;)
+		{
+			if (data[i] == value)
+			{
+				return i;
+			}
+		}
+		return count;
+	}
+
+	template <typename T>
+	static auto bitsOf(const T& value) noexcept
+	{
+		using Bits = std::conditional_t<sizeof(T) == 1, uint8_t,
+			std::conditional_t<sizeof(T) == 2, uint16_t,
+			std::conditional_t<sizeof(T) == 4, uint32_t, uint64_t>>>;
+		Bits bits;
+		std::memcpy(&bits, &value, sizeof(T));
+		return bits;
+	}
+
+	// SSE2 and AVX2 kernels return a byte mask with sizeof(T) bits per matching
+	// element; AVX-512 kernels return one bit per element.
+
+#if defined(ABOUTTT_SIMD_SSE2)
+	template <typename T>
+	static __m128i broadcastSse2(const T& value) noexcept
+	{
+		auto bits = bitsOf(value);
+		if constexpr (sizeof(T) == 1)
+		{
+			return _mm_set1_epi8(static_cast<char>(bits));
+		}
+		else if constexpr (sizeof(T) == 2)
+		{
+			return _mm_set1_epi16(static_cast<short>(bits));
+		}
+		else if constexpr (sizeof(T) == 4)
+		{
+			return _mm_set1_epi32(static_cast<int>(bits));
+		}
+		else
+		{
+			return _mm_set1_epi64x(static_cast<long long>(bits));
+		}
+	}
+
+	template <typename T>
+	static uint32_t matchSse2(const T* block, __m128i needle) noexcept
+	{
+		__m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block));
+		__m128i equal;
+		if constexpr (std::is_floating_point_v<T> && sizeof(T) == 4)
+		{
+			equal = _mm_castps_si128(_mm_cmpeq_ps(_mm_castsi128_ps(values), _mm_castsi128_ps(needle)));
+		}
+		else if constexpr (std::is_floating_point_v<T>)
+		{
+			equal = _mm_castpd_si128(_mm_cmpeq_pd(_mm_castsi128_pd(values), _mm_castsi128_pd(needle)));
+		}
+		else if constexpr (sizeof(T) == 1)
+		{
+			equal = _mm_cmpeq_epi8(values, needle);
+		}
+		else if constexpr (sizeof(T) == 2)
+		{
+			equal = _mm_cmpeq_epi16(values, needle);
+		}
+		else if constexpr (sizeof(T) == 4)
+		{
+			equal = _mm_cmpeq_epi32(values, needle);
+		}
+		else
+		{
+			// SSE2 has no 64-bit compare: both 32-bit halves must match.
+			equal = _mm_cmpeq_epi32(values, needle);
+			equal = _mm_and_si128(equal, _mm_shuffle_epi32(equal, _MM_SHUFFLE(2, 3, 0, 1)));
+		}
+		return static_cast<uint32_t>(_mm_movemask_epi8(equal));
+	}
+
+	template <typename T>
+	static size_t findSse2(const T* data, size_t count, const T& value) noexcept
+	{
+		constexpr size_t lanes = 16 / sizeof(T);
+		__m128i needle = broadcastSse2(value);
+		size_t i = 0;
+		for (; i + lanes <= count; i += lanes)
+		{
+			uint32_t mask = matchSse2(data + i, needle);
+			if (mask != 0)
+			{
+				return i + static_cast<size_t>(std::countr_zero(mask)) / sizeof(T);
+			}
+		}
+		return findScalar(data, i, count, value);
+	}
+
+	template <typename T>
+	static size_t findLastSse2(const T* data, size_t count, const T& value) noexcept
+	{
+		constexpr size_t lanes = 16 / sizeof(T);
+		__m128i needle = broadcastSse2(value);
+		size_t i = count;
+		for (size_t tail = count % lanes; tail > 0; --tail)
+		{
+			if (data[--i] == value)
+			{
+				return i;
+			}
+		}
+		while (i > 0)
+		{
+			i -= lanes;
+			uint32_t mask = matchSse2(data + i, needle);
+			if (mask != 0)
+			{
+				return i + static_cast<size_t>(31 - std::countl_zero(mask)) / sizeof(T);
+			}
+		}
+		return count;
+	}
+#endif // ABOUTTT_SIMD_SSE2
+
+#if defined(ABOUTTT_SIMD_AVX)
+	template <typename T>
+	__attribute__((target("avx2"))) static __m256i broadcastAvx2(const T& value) noexcept
+	{
+		auto bits = bitsOf(value);
+		if constexpr (sizeof(T) == 1)
+		{
+			return _mm256_set1_epi8(static_cast<char>(bits));
+		}
+		else if constexpr (sizeof(T) == 2)
+		{
+			return _mm256_set1_epi16(static_cast<short>(bits));
+		}
+		else if constexpr (sizeof(T) == 4)
+		{
+			return _mm256_set1_epi32(static_cast<int>(bits));
+		}
+		else
+		{
+			return _mm256_set1_epi64x(static_cast<long long>(bits));
+		}
+	}
+
+	template <typename T>
+	__attribute__((target("avx2"))) static uint32_t matchAvx2(const T* block, __m256i needle) noexcept
+	{
+		__m256i values = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block));
+		__m256i equal;
+		if constexpr (std::is_floating_point_v<T> && sizeof(T) == 4)
+		{
+			equal = _mm256_castps_si256(_mm256_cmp_ps(_mm256_castsi256_ps(values), _mm256_castsi256_ps(needle), _CMP_EQ_OQ));
+		}
+		else if constexpr (std::is_floating_point_v<T>)
+		{
+			equal = _mm256_castpd_si256(_mm256_cmp_pd(_mm256_castsi256_pd(values), _mm256_castsi256_pd(needle), _CMP_EQ_OQ));
+		}
+		else if constexpr (sizeof(T) == 1)
+		{
+			equal = _mm256_cmpeq_epi8(values, needle);
+		}
+		else if constexpr (sizeof(T) == 2)
+		{
+			equal = _mm256_cmpeq_epi16(values, needle);
+		}
+		else if constexpr (sizeof(T) == 4)
+		{
+			equal = _mm256_cmpeq_epi32(values, needle);
+		}
+		else
+		{
+			equal = _mm256_cmpeq_epi64(values, needle);
+		}
+		return static_cast<uint32_t>(_mm256_movemask_epi8(equal));
+	}
+
+	template <typename T>
+	__attribute__((target("avx2"))) static size_t findAvx2(const T* data, size_t count, const T& value) noexcept
+	{
+		constexpr size_t lanes = 32 / sizeof(T);
+		__m256i needle = broadcastAvx2(value);
+		size_t i = 0;
+		for (; i + lanes <= count; i += lanes)
+		{
+			uint32_t mask = matchAvx2(data + i, needle);
+			if (mask != 0)
+			{
+				return i + static_cast<size_t>(std::countr_zero(mask)) / sizeof(T);
+			}
+		}
+		return findScalar(data, i, count, value);
+	}
+
+	template <typename T>
+	__attribute__((target("avx2"))) static size_t findLastAvx2(const T* data, size_t count, const T& value) noexcept
+	{
+		constexpr size_t lanes = 32 / sizeof(T);
+		__m256i needle = broadcastAvx2(value);
+		size_t i = count;
+		for (size_t tail = count % lanes; tail > 0; --tail)
+		{
+			if (data[--i] == value)
+			{
+				return i;
+			}
+		}
+		while (i > 0)
+		{
+			i -= lanes;
+			uint32_t mask = matchAvx2(data + i, needle);
+			if (mask != 0)
+			{
+				return i + static_cast<size_t>(31 - std::countl_zero(mask)) / sizeof(T);
+			}
+		}
+		return count;
+	}
+
+	template <typename T>
+	__attribute__((target("avx512f,avx512bw"))) static __m512i broadcastAvx512(const T& value) noexcept
+	{
+		auto bits = bitsOf(value);
+		if constexpr (sizeof(T) == 1)
+		{
+			return _mm512_set1_epi8(static_cast<char>(bits));
+		}
+		else if constexpr (sizeof(T) == 2)
+		{
+			return _mm512_set1_epi16(static_cast<short>(bits));
+		}
+		else if constexpr (sizeof(T) == 4)
+		{
+			return _mm512_set1_epi32(static_cast<int>(bits));
+		}
+		else
+		{
+			return _mm512_set1_epi64(static_cast<long long>(bits));
+		}
+	}
+
+	template <typename T>
+	__attribute__((target("avx512f,avx512bw"))) static uint64_t matchAvx512(const T* block, __m512i needle) noexcept
+	{
+		__m512i values = _mm512_loadu_si512(block);
+		if constexpr (std::is_floating_point_v<T> && sizeof(T) == 4)
+		{
+			return _mm512_cmp_ps_mask(_mm512_castsi512_ps(values), _mm512_castsi512_ps(needle), _CMP_EQ_OQ);
+		}
+		else if constexpr (std::is_floating_point_v<T>)
+		{
+			return _mm512_cmp_pd_mask(_mm512_castsi512_pd(values), _mm512_castsi512_pd(needle), _CMP_EQ_OQ);
+		}
+		else if constexpr (sizeof(T) == 1)
+		{
+			return _mm512_cmpeq_epi8_mask(values, needle);
+		}
+		else if constexpr (sizeof(T) == 2)
+		{
+			return _mm512_cmpeq_epi16_mask(values, needle);
+		}
+		else if constexpr (sizeof(T) == 4)
+		{
+			return _mm512_cmpeq_epi32_mask(values, needle);
+		}
+		else
+		{
+			return _mm512_cmpeq_epi64_mask(values, needle);
+		}
+	}
+
+	template <typename T>
+	__attribute__((target("avx512f,avx512bw"))) static size_t findAvx512(const T* data, size_t count, const T& value) noexcept
+	{
+		constexpr size_t lanes = 64 / sizeof(T);
+		__m512i needle = broadcastAvx512(value);
+		size_t i = 0;
+		for (; i + lanes <= count; i += lanes)
+		{
+			uint64_t mask = matchAvx512(data + i, needle);
+			if (mask != 0)
+			{
+				return i + static_cast<size_t>(std::countr_zero(mask));
+			}
+		}
+		return findScalar(data, i, count, value);
+	}
+
+	template <typename T>
+	__attribute__((target("avx512f,avx512bw"))) static size_t findLastAvx512(const T* data, size_t count, const T& value) noexcept
+	{
+		constexpr size_t lanes = 64 / sizeof(T);
+		__m512i needle = broadcastAvx512(value);
+		size_t i = count;
+		for (size_t tail = count % lanes; tail > 0; --tail)
+		{
+			if (data[--i] == value)
+			{
+				return i;
+			}
+		}
+		while (i > 0)
+		{
+			i -= lanes;
+			uint64_t mask = matchAvx512(data + i, needle);
+			if (mask != 0)
+			{
+				return i + static_cast<size_t>(63 - std::countl_zero(mask));
+			}
+		}
+		return count;
+	}
+#endif // ABOUTTT_SIMD_AVX
+
+#if defined(ABOUTTT_SIMD_NEON)
+	// Returns a mask with 4 * sizeof(T) bits per matching element.
+	template <typename T>
+	static uint64_t matchNeon(const T* block, const T& value) noexcept
+	{
+		auto bits = bitsOf(value);
+		uint8x16_t equal;
+		if constexpr (std::is_floating_point_v<T> && sizeof(T) == 4)
+		{
+			equal = vreinterpretq_u8_u32(vceqq_f32(vld1q_f32(reinterpret_cast<const float*>(block)), vdupq_n_f32(value)));
+		}
+		else if constexpr (std::is_floating_point_v<T>)
+		{
+			equal = vreinterpretq_u8_u64(vceqq_f64(vld1q_f64(reinterpret_cast<const double*>(block)), vdupq_n_f64(value)));
+		}
+		else if constexpr (sizeof(T) == 1)
+		{
+			equal = vceqq_u8(vld1q_u8(reinterpret_cast<const uint8_t*>(block)), vdupq_n_u8(bits));
+		}
+		else if constexpr (sizeof(T) == 2)
+		{
+			equal = vreinterpretq_u8_u16(vceqq_u16(vld1q_u16(reinterpret_cast<const uint16_t*>(block)), vdupq_n_u16(bits)));
+		}
+		else if constexpr (sizeof(T) == 4)
+		{
+			equal = vreinterpretq_u8_u32(vceqq_u32(vld1q_u32(reinterpret_cast<const uint32_t*>(block)), vdupq_n_u32(bits)));
+		}
+		else
+		{
+			equal = vreinterpretq_u8_u64(vceqq_u64(vld1q_u64(reinterpret_cast<const uint64_t*>(block)), vdupq_n_u64(bits)));
+		}
+		// Narrowing shift packs each byte of the compare result into a nibble.
+		uint8x8_t packed = vshrn_n_u16(vreinterpretq_u16_u8(equal), 4);
+		return vget_lane_u64(vreinterpret_u64_u8(packed), 0);
+	}
+
+	template <typename T>
+	static size_t findNeon(const T* data, size_t count, const T& value) noexcept
+	{
+		constexpr size_t lanes = 16 / sizeof(T);
+		size_t i = 0;
+		for (; i + lanes <= count; i += lanes)
+		{
+			uint64_t mask = matchNeon(data + i, value);
+			if (mask != 0)
+			{
+				return i + static_cast<size_t>(std::countr_zero(mask)) / (4 * sizeof(T));
+			}
+		}
+		return findScalar(data, i, count, value);
+	}
+
+	template <typename T>
+	static size_t findLastNeon(const T* data, size_t count, const T& value) noexcept
+	{
+		constexpr size_t lanes = 16 / sizeof(T);
+		size_t i = count;
+		for (size_t tail = count % lanes; tail > 0; --tail)
+		{
+			if (data[--i] == value)
+			{
+				return i;
+			}
+		}
+		while (i > 0)
+		{
+			i -= lanes;
+			uint64_t mask = matchNeon(data + i, value);
+			if (mask != 0)
+			{
+				return i + static_cast<size_t>(63 - std::countl_zero(mask)) / (4 * sizeof(T));
+			}
+		}
+		return count;
+	}
+#endif // ABOUTTT_SIMD_NEON
+};
+
+} // namespace abouttt
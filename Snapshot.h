@@ -0,0 +1,513 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+#include "Array.h"
+#include "ArrayView.h"
+#include "GrowthPolicy.h"
+#include "Memory.h"
+#include "PriorityQueue.h"
+
+#if !ABOUTTT_HAS_PAGE_MAPPING
+#error "Snapshot.h requires a platform with POSIX file mapping"
+#endif
+
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace abouttt
+{
+
+// "ABTTSNAP" when the header is read as bytes on a little-endian machine.
+inline constexpr uint64_t SNAPSHOT_MAGIC = 0x50414E5354544241;
+inline constexpr uint32_t SNAPSHOT_VERSION = 1;
+
+// A snapshot is this header followed directly by the elements, in the byte order
+// of the machine that wrote it. The header is one cache line, so element storage
+// in a mapping is aligned for any T with alignof(T) <= 64.
+struct SnapshotHeader
+{
+	uint64_t mMagic;
+	uint32_t mVersion;
+	uint32_t mElementSize;
+	uint32_t mElementAlign;
+	// Arity of the heap the elements form, or 0 for a plain sequence.
+	uint32_t mHeapArity;
+	uint64_t mCount;
+	uint64_t mChecksum;
+	uint8_t mReserved[24];
+};
+
+static_assert(sizeof(SnapshotHeader) == 64, "SnapshotHeader must be one cache line");
+
+inline constexpr size_t SNAPSHOT_DATA_OFFSET = sizeof(SnapshotHeader);
+
+// Four independent multiply-xorshift lanes over 8-byte words, fast enough to run
+// at memory bandwidth. It catches truncation and corruption, not tampering.
+inline uint64_t SnapshotChecksum(const void* data, size_t bytes) noexcept
+{
+	constexpr uint64_t MULTIPLIER = 0x9E3779B97F4A7C15;
+	const unsigned char* p = static_cast<const unsigned char*>(data);
+	uint64_t lanes[4] = { 1, 2, 3, 4 };
+
+	auto mix = [](uint64_t lane, uint64_t word) {
+		lane = (lane ^ word) * MULTIPLIER;
+		return lane ^ (lane >> 29);
+	};
+
+	size_t i = 0;
+	for (; i + 32 <= bytes; i += 32)
+	{
+		for (size_t lane = 0; lane < 4; ++lane)
+		{
+			uint64_t word;
+			std::memcpy(&word, p + i + 8 * lane, 8);
+			lanes[lane] = mix(lanes[lane], word);
+		}
+	}
+	for (; i < bytes; i += 8)
+	{
+		uint64_t word = 0;
+		std::memcpy(&word, p + i, std::min<size_t>(8, bytes - i));
+		lanes[0] = mix(lanes[0], word);
+	}
+
+	uint64_t hash = mix(bytes, lanes[0]);
+	hash = mix(hash, lanes[1]);
+	hash = mix(hash, lanes[2]);
+	return mix(hash, lanes[3]);
+}
+
+// Writes count elements to path with a single writev of the header and the
+// element bytes. They go to a temporary file next to path, which is synced and
+// then renamed over it. Existing mappings of path keep the old file, and a crash
+// midway leaves the old snapshot intact.
+template <typename T>
+void WriteSnapshot(const char* path, const T* data, size_t count, uint32_t heapArity = 0)
+{
+	static_assert(std::is_trivially_copyable_v<T>, "Snapshots require a trivially copyable T");
+	static_assert(alignof(T) <= SNAPSHOT_DATA_OFFSET, "Snapshot elements must not be over-aligned");
+
+	size_t bytes = sizeof(T) * count;
+	SnapshotHeader header{};
+	header.mMagic = SNAPSHOT_MAGIC;
+	header.mVersion = SNAPSHOT_VERSION;
+	header.mElementSize = static_cast<uint32_t>(sizeof(T));
+	header.mElementAlign = static_cast<uint32_t>(alignof(T));
+	header.mHeapArity = heapArity;
+	header.mCount = count;
+	header.mChecksum = SnapshotChecksum(data, bytes);
+
+	std::string tempPath = std::string(path) + ".XXXXXX";
+	int fd = ::mkostemp(tempPath.data(), O_CLOEXEC);
+	if (fd < 0)
+	{
+		throw std::system_error(errno, std::generic_category(), path);
+	}
+
+	auto fail = [&](int error)
+	{
+		if (fd >= 0)
+		{
+			::close(fd);
+		}
+		::unlink(tempPath.c_str());
+		throw std::system_error(error, std::generic_category(), path);
+	};
+
+	if (::fchmod(fd, 0644) != 0)
+	{
+		fail(errno);
+	}
+
+	iovec parts[2] = { { &header, sizeof(header) }, { const_cast<T*>(data), bytes } };
+	iovec* part = parts;
+	int partCount = bytes > 0 ? 2 : 1;
+	while (partCount > 0)
+	{
+		ssize_t written = ::writev(fd, part, partCount);
+		if (written < 0)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+			fail(errno);
+		}
+
+		// Skip whatever a short write got through and resume mid-part.
+		size_t done = static_cast<size_t>(written);
+		while (partCount > 0 && done >= part->iov_len)
+		{
+			done -= part->iov_len;
+			++part;
+			--partCount;
+		}
+		if (partCount > 0)
+		{
+			part->iov_base = static_cast<char*>(part->iov_base) + done;
+			part->iov_len -= done;
+		}
+	}
+
+	if (::fsync(fd) != 0)
+	{
+		fail(errno);
+	}
+	int closed = ::close(fd);
+	fd = -1;
+	if (closed != 0 || ::rename(tempPath.c_str(), path) != 0)
+	{
+		fail(errno);
+	}
+}
+
+template <typename T, typename Allocator, typename Growth, size_t N>
+void WriteSnapshot(const char* path, const Array<T, Allocator, Growth, N>& array)
+{
+	WriteSnapshot(path, array.Data(), array.Count());
+}
+
+// Records the heap arity so that MapPriorityQueue can adopt the elements as they are.
+template <typename T, typename Compare, typename Allocator, size_t Arity, typename Growth>
+void WriteSnapshot(const char* path, const PriorityQueue<T, Compare, Allocator, Arity, Growth>& queue)
+{
+	WriteSnapshot(path, queue.Data(), queue.Count(), static_cast<uint32_t>(Arity));
+}
+
+// A validated snapshot file mapped MAP_PRIVATE. A writable mapping is copy on
+// write: pages are shared with the page cache until stored to, and stores never
+// reach the file. The mapping extends to the end of the last page, so the slack
+// after the elements is usable, zeroed storage.
+class SnapshotMapping
+{
+public:
+	SnapshotMapping() noexcept
+		: mBase(nullptr)
+		, mBytes(0)
+	{
+	}
+
+	SnapshotMapping(const char* path, size_t elementSize, size_t elementAlign, bool bWritable = false, bool bVerifyChecksum = true)
+		: SnapshotMapping()
+	{
+		int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+		if (fd < 0)
+		{
+			throw std::system_error(errno, std::generic_category(), path);
+		}
+
+		struct stat status;
+		if (::fstat(fd, &status) != 0)
+		{
+			int error = errno;
+			::close(fd);
+			throw std::system_error(error, std::generic_category(), path);
+		}
+		size_t fileBytes = static_cast<size_t>(status.st_size);
+		if (fileBytes < sizeof(SnapshotHeader))
+		{
+			::close(fd);
+			throw std::runtime_error("Snapshot is truncated");
+		}
+
+		size_t mappingBytes = (fileBytes + PageSize() - 1) & ~(PageSize() - 1);
+		int protection = bWritable ? PROT_READ | PROT_WRITE : PROT_READ;
+		void* base = ::mmap(nullptr, mappingBytes, protection, MAP_PRIVATE, fd, 0);
+		int error = errno;
+		::close(fd);
+		if (base == MAP_FAILED)
+		{
+			throw std::system_error(error, std::generic_category(), path);
+		}
+		mBase = static_cast<unsigned char*>(base);
+		mBytes = mappingBytes;
+
+		const SnapshotHeader& header = Header();
+		const char* problem = nullptr;
+		if (header.mMagic != SNAPSHOT_MAGIC)
+		{
+			problem = "Not a snapshot";
+		}
+		else if (header.mVersion != SNAPSHOT_VERSION)
+		{
+			problem = "Unsupported snapshot version";
+		}
+		else if (header.mElementSize != elementSize)
+		{
+			problem = "Snapshot element size mismatch";
+		}
+		else if (header.mElementAlign != elementAlign)
+		{
+			problem = "Snapshot element alignment mismatch";
+		}
+		else if (header.mCount > (fileBytes - sizeof(SnapshotHeader)) / elementSize
+			|| fileBytes != sizeof(SnapshotHeader) + elementSize * header.mCount)
+		{
+			problem = "Snapshot size does not match its count";
+		}
+		else if (bVerifyChecksum && SnapshotChecksum(Data(), elementSize * header.mCount) != header.mChecksum)
+		{
+			problem = "Snapshot checksum mismatch";
+		}
+		if (problem)
+		{
+			Reset();
+			throw std::runtime_error(problem);
+		}
+	}
+
+	SnapshotMapping(const SnapshotMapping&) = delete;
+
+	SnapshotMapping(SnapshotMapping&& other) noexcept
+		: mBase(std::exchange(other.mBase, nullptr))
+		, mBytes(std::exchange(other.mBytes, 0))
+	{
+	}
+
+	~SnapshotMapping()
+	{
+		Reset();
+	}
+
+public:
+	SnapshotMapping& operator=(const SnapshotMapping&) = delete;
+
+	SnapshotMapping& operator=(SnapshotMapping&& other) noexcept
+	{
+		if (this != &other)
+		{
+			Reset();
+			mBase = std::exchange(other.mBase, nullptr);
+			mBytes = std::exchange(other.mBytes, 0);
+		}
+		return *this;
+	}
+
+public:
+	// Size of the mapping, including the header and the slack in the last page.
+	size_t Bytes() const noexcept
+	{
+		return mBytes;
+	}
+
+	void* Data() const noexcept
+	{
+		return mBase ? mBase + SNAPSHOT_DATA_OFFSET : nullptr;
+	}
+
+	const SnapshotHeader& Header() const noexcept
+	{
+		return *reinterpret_cast<const SnapshotHeader*>(mBase);
+	}
+
+	bool IsMapped() const noexcept
+	{
+		return mBase != nullptr;
+	}
+
+	void Reset() noexcept
+	{
+		if (mBase)
+		{
+			UnmapPages(mBase, mBytes);
+			mBase = nullptr;
+			mBytes = 0;
+		}
+	}
+
+private:
+	unsigned char* mBase;
+	size_t mBytes;
+};
+
+// Read-only view of a snapshot, served straight from the page cache. Opening it
+// costs a mapping and, unless skipped, one checksum pass; nothing is copied.
+template <typename T>
+class MappedArray
+{
+	static_assert(std::is_trivially_copyable_v<T>, "Snapshots require a trivially copyable T");
+	static_assert(alignof(T) <= SNAPSHOT_DATA_OFFSET, "Snapshot elements must not be over-aligned");
+
+public:
+	static constexpr size_t INDEX_NONE = Array<T>::INDEX_NONE;
+
+public:
+	MappedArray() noexcept = default;
+
+	explicit MappedArray(const char* path, bool bVerifyChecksum = true)
+		: mMapping(path, sizeof(T), alignof(T), false, bVerifyChecksum)
+	{
+	}
+
+public:
+	const T& operator[](size_t index) const noexcept
+	{
+		return Data()[index];
+	}
+
+public:
+	const T& At(size_t index) const
+	{
+		if (index >= Count())
+		{
+			throw std::out_of_range("Index out of range");
+		}
+		return Data()[index];
+	}
+
+	bool Contains(const T& value) const
+	{
+		return Find(value) != INDEX_NONE;
+	}
+
+	size_t Count() const noexcept
+	{
+		return mMapping.IsMapped() ? static_cast<size_t>(mMapping.Header().mCount) : 0;
+	}
+
+	const T* Data() const noexcept
+	{
+		return static_cast<const T*>(mMapping.Data());
+	}
+
+	size_t Find(const T& value) const
+	{
+		return View().Find(value);
+	}
+
+	// Arity of the heap the snapshot was written from, or 0.
+	uint32_t HeapArity() const noexcept
+	{
+		return mMapping.IsMapped() ? mMapping.Header().mHeapArity : 0;
+	}
+
+	bool IsEmpty() const noexcept
+	{
+		return Count() == 0;
+	}
+
+	ArrayView<const T> View() const noexcept
+	{
+		return ArrayView<const T>(Data(), Count());
+	}
+
+public: // Iterators for range-based loop support.
+	const T* begin() const noexcept
+	{
+		return Data();
+	}
+
+	const T* end() const noexcept
+	{
+		return Data() + Count();
+	}
+
+private:
+	SnapshotMapping mMapping;
+};
+
+// Allocator for containers that adopt a snapshot mapping as their initial
+// storage. Deallocating the mapped elements unmaps the file; every other request
+// goes to the heap, so the container grows and shrinks as usual.
+template <typename T>
+class MappedAllocator
+{
+	template <typename U>
+	friend class MappedAllocator;
+
+public:
+	using value_type = T;
+	using propagate_on_container_copy_assignment = std::false_type;
+	using propagate_on_container_move_assignment = std::true_type;
+	using propagate_on_container_swap = std::true_type;
+
+public:
+	MappedAllocator() noexcept = default;
+
+	explicit MappedAllocator(std::shared_ptr<SnapshotMapping> mapping) noexcept
+		: mMapping(std::move(mapping))
+	{
+	}
+
+	template <typename U>
+	MappedAllocator(const MappedAllocator<U>& other) noexcept
+		: mMapping(other.mMapping)
+	{
+	}
+
+public:
+	template <typename U>
+	bool operator==(const MappedAllocator<U>& other) const noexcept
+	{
+		return mMapping == other.mMapping;
+	}
+
+public:
+	T* allocate(size_t count)
+	{
+		return std::allocator<T>().allocate(count);
+	}
+
+	// GCC follows the mapped pointer into the heap branch it can never reach.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wfree-nonheap-object"
+#endif
+	void deallocate(T* ptr, size_t count) noexcept
+	{
+		if (mMapping && ptr == mMapping->Data())
+		{
+			mMapping->Reset();
+		}
+		else
+		{
+			std::allocator<T>().deallocate(ptr, count);
+		}
+	}
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+private:
+	std::shared_ptr<SnapshotMapping> mMapping;
+};
+
+// Opens a snapshot written from a PriorityQueue of the same Arity and adopts the
+// mapped elements as the heap, without moving or comparing them. Pages are copied
+// only as Enqueue and Dequeue touch them; the file is never modified. Comp must
+// order the elements as the queue that wrote them did.
+template <typename T, typename Compare = std::less<T>, size_t Arity = 2, typename Growth = DefaultGrowth>
+PriorityQueue<T, Compare, MappedAllocator<T>, Arity, Growth> MapPriorityQueue(const char* path,
+	const Compare& comp = Compare(), bool bVerifyChecksum = true)
+{
+	static_assert(std::is_trivially_copyable_v<T>, "Snapshots require a trivially copyable T");
+	static_assert(alignof(T) <= SNAPSHOT_DATA_OFFSET, "Snapshot elements must not be over-aligned");
+
+	auto mapping = std::make_shared<SnapshotMapping>(path, sizeof(T), alignof(T), true, bVerifyChecksum);
+	if (mapping->Header().mHeapArity != Arity)
+	{
+		throw std::runtime_error("Snapshot was not written from a heap of this arity");
+	}
+
+	T* data = static_cast<T*>(mapping->Data());
+	size_t count = static_cast<size_t>(mapping->Header().mCount);
+	size_t capacity = (mapping->Bytes() - SNAPSHOT_DATA_OFFSET) / sizeof(T);
+	return PriorityQueue<T, Compare, MappedAllocator<T>, Arity, Growth>(
+		ADOPT_HEAP, data, count, capacity, comp, MappedAllocator<T>(std::move(mapping)));
+}
+
+} // namespace abouttt
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <thread>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#endif
+
+namespace abouttt
+{
+
+// Hints the CPU that the caller is busy-waiting.
+inline void CpuRelax() noexcept
+{
+#if defined(__x86_64__) || defined(__i386__)
+	__builtin_ia32_pause();
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+	_mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+	__asm__ __volatile__("yield");
+#endif
+}
+
+// How a blocking operation waits: spin with CpuRelax(), then yield the time
+// slice, then park the thread until it is notified.
+struct WaitPolicy
+{
+	size_t mSpinCount = 256;
+	size_t mYieldCount = 16;
+};
+
+// Drives one blocking wait according to a WaitPolicy. Once spinning and
+// yielding are exhausted, ShouldPark() returns true.
+class SpinWait
+{
+public:
+	explicit SpinWait(const WaitPolicy& policy) noexcept
+		: mPolicy(policy)
+		, mIteration(0)
+	{
+	}
+
+public:
+	bool ShouldPark() const noexcept
+	{
+		return mIteration >= mPolicy.mSpinCount + mPolicy.mYieldCount;
+	}
+
+	void SpinOnce() noexcept
+	{
+		if (mIteration < mPolicy.mSpinCount)
+		{
+			CpuRelax();
+		}
+		else
+		{
+			std::this_thread::yield();
+		}
+		++mIteration;
+	}
+
+private:
+	WaitPolicy mPolicy;
+	size_t mIteration;
+};
+
+// Test-and-test-and-set lock for very short critical sections.
+class SpinLock
+{
+public:
+	SpinLock() noexcept
+		: mLocked(false)
+	{
+	}
+
+	SpinLock(const SpinLock&) = delete;
+
+public:
+	SpinLock& operator=(const SpinLock&) = delete;
+
+public:
+	void Lock() noexcept
+	{
+		while (!TryLock())
+		{
+			while (mLocked.load(std::memory_order_relaxed))
+			{
+				CpuRelax();
+			}
+		}
+	}
+
+	bool TryLock() noexcept
+	{
+		return !mLocked.load(std::memory_order_relaxed) && !mLocked.exchange(true, std::memory_order_acquire);
+	}
+
+	void Unlock() noexcept
+	{
+		mLocked.store(false, std::memory_order_release);
+	}
+
+private:
+	std::atomic<bool> mLocked;
+};
+
+} // namespace abouttt
@@ -0,0 +1,184 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "Memory.h"
+
+namespace abouttt
+{
+
+// Bounded wait-free queue for exactly one producer thread and one consumer thread.
+// TryEnqueue/TryEmplace may only be called by the producer; Peek, Dequeue and
+// TryDequeue only by the consumer.
+template <typename T, typename Allocator = std::allocator<T>>
+class SpscQueue
+{
+	static_assert(std::is_same_v<typename Allocator::value_type, T>, "Allocator::value_type must be T");
+
+private:
+	using AllocatorTraits = std::allocator_traits<Allocator>;
+
+public:
+	using AllocatorType = Allocator;
+
+public:
+	// Capacity is rounded up to a power of two.
+	explicit SpscQueue(size_t capacity, const Allocator& alloc = Allocator())
+		: mAllocator(alloc)
+		, mCapacity(std::bit_ceil(std::max<size_t>(capacity, 1)))
+		, mMask(mCapacity - 1)
+		, mData(AllocatorTraits::allocate(mAllocator, mCapacity))
+		, mHead(0)
+		, mCachedTail(0)
+		, mTail(0)
+		, mCachedHead(0)
+	{
+	}
+
+	SpscQueue(const SpscQueue&) = delete;
+
+	~SpscQueue()
+	{
+		size_t head = mHead.load(std::memory_order_relaxed);
+		size_t tail = mTail.load(std::memory_order_relaxed);
+		for (; head != tail; ++head)
+		{
+			std::destroy_at(mData + (head & mMask));
+		}
+		AllocatorTraits::deallocate(mAllocator, mData, mCapacity);
+	}
+
+public:
+	SpscQueue& operator=(const SpscQueue&) = delete;
+
+public:
+	size_t Capacity() const noexcept
+	{
+		return mCapacity;
+	}
+
+	// Exact from the producer or consumer thread while the other is idle, and
+	// approximate otherwise. Head is loaded first, so the tail seen after it never
+	// trails it; elements taken and added between the two loads can push the
+	// difference past the capacity, so it is clamped.
+	size_t Count() const noexcept
+	{
+		size_t head = mHead.load(std::memory_order_acquire);
+		size_t tail = mTail.load(std::memory_order_acquire);
+		return std::min(tail - head, mCapacity);
+	}
+
+	// Consumer only.
+	void Dequeue()
+	{
+		size_t head = mHead.load(std::memory_order_relaxed);
+		checkEmpty(head);
+		std::destroy_at(mData + (head & mMask));
+		mHead.store(head + 1, std::memory_order_release);
+	}
+
+	bool IsEmpty() const noexcept
+	{
+		return Count() == 0;
+	}
+
+	// Consumer only.
+	T& Peek()
+	{
+		size_t head = mHead.load(std::memory_order_relaxed);
+		checkEmpty(head);
+		return mData[head & mMask];
+	}
+
+	// Consumer only.
+	bool TryDequeue(T& outValue)
+	{
+		size_t head = mHead.load(std::memory_order_relaxed);
+		if (!hasElement(head))
+		{
+			return false;
+		}
+
+		T* slot = mData + (head & mMask);
+		outValue = std::move(*slot);
+		std::destroy_at(slot);
+		mHead.store(head + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Producer only.
+	template <typename... Args>
+	bool TryEmplace(Args&&... args)
+	{
+		size_t tail = mTail.load(std::memory_order_relaxed);
+		if (tail - mCachedHead == mCapacity)
+		{
+			mCachedHead = mHead.load(std::memory_order_acquire);
+			if (tail - mCachedHead == mCapacity)
+			{
+				return false;
+			}
+		}
+
+		std::construct_at(mData + (tail & mMask), std::forward<Args>(args)...);
+		mTail.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Producer only.
+	bool TryEnqueue(const T& value)
+	{
+		return TryEmplace(value);
+	}
+
+	// Producer only.
+	bool TryEnqueue(T&& value)
+	{
+		return TryEmplace(std::move(value));
+	}
+
+private:
+	bool hasElement(size_t head) noexcept
+	{
+		if (head == mCachedTail)
+		{
+			mCachedTail = mTail.load(std::memory_order_acquire);
+			if (head == mCachedTail)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	void checkEmpty(size_t head)
+	{
+		if (!hasElement(head))
+		{
+			throw std::out_of_range("Queue is empty");
+		}
+	}
+
+private:
+	[[no_unique_address]] Allocator mAllocator;
+	const size_t mCapacity;
+	const size_t mMask;
+	T* const mData;
+
+	// Written by the consumer.
+	alignas(CACHE_LINE_SIZE) std::atomic<size_t> mHead;
+	size_t mCachedTail;
+
+	// Written by the producer.
+	alignas(CACHE_LINE_SIZE) std::atomic<size_t> mTail;
+	size_t mCachedHead;
+};
+
+} // namespace abouttt
@@ -6,48 +6,90 @@
 #include <memory>
 #include <new>
 #include <stdexcept>
+#include <type_traits>
 #include <utility>
 
+#include "ArrayView.h"
+#include "GrowthPolicy.h"
+#include "Instrumentation.h"
+#include "Memory.h"
+
 namespace abouttt
 {
 
-template <typename T>
+template <typename T, typename Allocator = std::allocator<T>, typename Growth = DefaultGrowth>
 class Stack
 {
+	static_assert(std::is_same_v<typename Allocator::value_type, T>, "Allocator::value_type must be T");
+
+private:
+	using AllocatorTraits = std::allocator_traits<Allocator>;
+
+public:
+	using AllocatorType = Allocator;
+
 public:
 	Stack() noexcept
 		: Stack(0)
 	{
 	}
 
-	explicit Stack(size_t capacity)
-		: mData(capacity > 0 ? static_cast<T*>(::operator new(sizeof(T) * capacity)) : nullptr)
+	explicit Stack(const Allocator& alloc) noexcept
+		: Stack(0, alloc)
+	{
+	}
+
+	explicit Stack(size_t capacity, const Allocator& alloc = Allocator())
+		: mAllocator(alloc)
+		, mData(capacity > 0 ? AllocatorTraits::allocate(mAllocator, capacity) : nullptr)
 		, mCount(0)
 		, mCapacity(capacity)
 	{
 	}
 
-	Stack(std::initializer_list<T> ilist)
-		: Stack(ilist.size())
+	Stack(std::initializer_list<T> ilist, const Allocator& alloc = Allocator())
+		: Stack(ilist.size(), alloc)
 	{
 		std::uninitialized_copy(ilist.begin(), ilist.end(), mData);
 		mCount = ilist.size();
 	}
 
 	Stack(const Stack& other)
-		: Stack(other.mCount)
+		: Stack(other, AllocatorTraits::select_on_container_copy_construction(other.mAllocator))
+	{
+	}
+
+	Stack(const Stack& other, const Allocator& alloc)
+		: Stack(other.mCount, alloc)
 	{
 		std::uninitialized_copy(other.mData, other.mData + other.mCount, mData);
 		mCount = other.mCount;
 	}
 
 	Stack(Stack&& other) noexcept
-		: mData(std::exchange(other.mData, nullptr))
+		: mAllocator(std::move(other.mAllocator))
+		, mData(std::exchange(other.mData, nullptr))
 		, mCount(std::exchange(other.mCount, 0))
 		, mCapacity(std::exchange(other.mCapacity, 0))
 	{
 	}
 
+	Stack(Stack&& other, const Allocator& alloc)
+		: Stack(alloc)
+	{
+		if (mAllocator == other.mAllocator)
+		{
+			swapStorage(other);
+		}
+		else
+		{
+			reallocate(other.mCount);
+			std::uninitialized_move_n(other.mData, other.mCount, mData);
+			mCount = other.mCount;
+			other.Clear();
+		}
+	}
+
 	~Stack()
 	{
 		cleanup();
@@ -58,28 +100,45 @@ public:
 	{
 		if (this != &other)
 		{
-			Stack temp(other);
-			Swap(temp);
+			if constexpr (AllocatorTraits::propagate_on_container_copy_assignment::value)
+			{
+				if (mAllocator != other.mAllocator)
+				{
+					cleanup();
+				}
+				mAllocator = other.mAllocator;
+			}
+			Stack temp(other, mAllocator);
+			swapStorage(temp);
 		}
 		return *this;
 	}
 
-	Stack& operator=(Stack&& other) noexcept
+	Stack& operator=(Stack&& other) noexcept(
+		AllocatorTraits::propagate_on_container_move_assignment::value ||
+		AllocatorTraits::is_always_equal::value)
 	{
 		if (this != &other)
 		{
-			cleanup();
-			mData = std::exchange(other.mData, nullptr);
-			mCount = std::exchange(other.mCount, 0);
-			mCapacity = std::exchange(other.mCapacity, 0);
+			if constexpr (AllocatorTraits::propagate_on_container_move_assignment::value)
+			{
+				cleanup();
+				mAllocator = std::move(other.mAllocator);
+				swapStorage(other);
+			}
+			else
+			{
+				Stack temp(std::move(other), mAllocator);
+				swapStorage(temp);
+			}
 		}
 		return *this;
 	}
 
 	Stack& operator=(std::initializer_list<T> ilist)
 	{
-		Stack temp(ilist);
-		Swap(temp);
+		Stack temp(ilist, mAllocator);
+		swapStorage(temp);
 		return *this;
 	}
 
@@ -105,14 +164,7 @@ public:
 
 	bool Contains(const T& value) const
 	{
-		for (size_t i = 0; i < mCount; ++i)
-		{
-			if (mData[i] == value)
-			{
-				return true;
-			}
-		}
-		return false;
+		return View().Contains(value);
 	}
 
 	size_t Count() const noexcept
@@ -128,6 +180,11 @@ public:
 		++mCount;
 	}
 
+	Allocator GetAllocator() const noexcept
+	{
+		return mAllocator;
+	}
+
 	bool IsEmpty() const noexcept
 	{
 		return mCount == 0;
@@ -145,11 +202,23 @@ public:
 		return mData[mCount - 1];
 	}
 
-	void Pop()
+	T Pop()
 	{
 		checkEmpty();
-		--mCount;
-		std::destroy_at(mData + mCount);
+		return popTop();
+	}
+
+	// Pops up to count elements, top first, into out and returns how many were popped.
+	template <typename OutputIt>
+	size_t PopN(size_t count, OutputIt out)
+	{
+		size_t popped = std::min(count, mCount);
+		for (size_t i = 0; i < popped; ++i)
+		{
+			*out = popTop();
+			++out;
+		}
+		return popped;
 	}
 
 	void Push(const T& value)
@@ -180,9 +249,28 @@ public:
 
 	void Swap(Stack& other) noexcept
 	{
-		std::swap(mData, other.mData);
-		std::swap(mCount, other.mCount);
-		std::swap(mCapacity, other.mCapacity);
+		if constexpr (AllocatorTraits::propagate_on_container_swap::value)
+		{
+			std::swap(mAllocator, other.mAllocator);
+		}
+		swapStorage(other);
+	}
+
+	bool TryPop(T& outValue)
+	{
+		if (mCount == 0)
+		{
+			return false;
+		}
+		outValue = popTop();
+		return true;
+	}
+
+	// The elements bottom first, so the top is the last. Valid until the stack is
+	// next modified.
+	ArrayView<const T> View() const noexcept
+	{
+		return ArrayView<const T>(mData, mCount);
 	}
 
 private:
@@ -198,12 +286,18 @@ private:
 	{
 		if (minCapacity > mCapacity)
 		{
-			size_t grow = mCapacity + (mCapacity >> 1); // Grow by 1.5x
-			size_t newCapacity = std::max(minCapacity, mCapacity == 0 ? 8 : grow);
-			reallocate(newCapacity);
+			reallocate(Growth::Grow(mCapacity, minCapacity, sizeof(T)));
 		}
 	}
 
+	T popTop()
+	{
+		T value = std::move(mData[mCount - 1]);
+		std::destroy_at(mData + mCount - 1);
+		--mCount;
+		return value;
+	}
+
 	void reallocate(size_t newCapacity)
 	{
 		if (newCapacity == mCapacity)
@@ -217,27 +311,36 @@ private:
 			return;
 		}
 
-		T* newData = static_cast<T*>(::operator new(sizeof(T) * newCapacity));
+		T* newData = AllocatorTraits::allocate(mAllocator, newCapacity);
 		size_t newCount = std::min(mCount, newCapacity);
 
 		if (mData)
 		{
-			std::uninitialized_move_n(mData, newCount, newData);
-			std::destroy_n(mData, mCount);
-			::operator delete(mData);
+			RelocateN(mData, newCount, newData);
+			std::destroy_n(mData + newCount, mCount - newCount);
+			AllocatorTraits::deallocate(mAllocator, mData, mCapacity);
 		}
+		RecordReallocation<Growth>(sizeof(T) * mCapacity, sizeof(T) * newCapacity, sizeof(T) * newCount, sizeof(T) * newCount);
+		ABOUTTT_INSTRUMENT(Reallocate, "Stack", this, sizeof(T) * newCount, sizeof(T) * newCapacity);
 
 		mData = newData;
 		mCount = newCount;
 		mCapacity = newCapacity;
 	}
 
+	void swapStorage(Stack& other) noexcept
+	{
+		std::swap(mData, other.mData);
+		std::swap(mCount, other.mCount);
+		std::swap(mCapacity, other.mCapacity);
+	}
+
 	void cleanup() noexcept
 	{
 		if (mData)
 		{
 			std::destroy_n(mData, mCount);
-			::operator delete(mData);
+			AllocatorTraits::deallocate(mAllocator, mData, mCapacity);
 			mData = nullptr;
 			mCount = 0;
 			mCapacity = 0;
@@ -245,6 +348,7 @@ private:
 	}
 
 private:
+	[[no_unique_address]] Allocator mAllocator;
 	T* mData;
 	size_t mCount;
 	size_t mCapacity;
@@ -0,0 +1,187 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#include "Queue.h"
+
+namespace abouttt
+{
+
+// Fixed set of worker threads fed from a FIFO Queue of tasks.
+class ThreadPool
+{
+public:
+	using Task = std::function<void()>;
+
+public:
+	// The default leaves one hardware thread for the caller, which takes part in
+	// ParallelFor.
+	explicit ThreadPool(size_t threadCount = std::max(1u, std::thread::hardware_concurrency()) - 1)
+		: mThreads(threadCount > 0 ? std::make_unique<std::thread[]>(threadCount) : nullptr)
+		, mThreadCount(threadCount)
+		, mbStopping(false)
+	{
+		for (size_t i = 0; i < mThreadCount; ++i)
+		{
+			mThreads[i] = std::thread([this] { workerLoop(); });
+		}
+	}
+
+	ThreadPool(const ThreadPool&) = delete;
+
+	// Finishes the queued tasks, then joins the workers.
+	~ThreadPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			mbStopping = true;
+		}
+		mCondition.notify_all();
+		for (size_t i = 0; i < mThreadCount; ++i)
+		{
+			mThreads[i].join();
+		}
+	}
+
+public:
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+public:
+	// Shared pool used by the parallel Array algorithms.
+	static ThreadPool& Default()
+	{
+		static ThreadPool pool;
+		return pool;
+	}
+
+	// Calls fn(begin, end) on disjoint chunks covering [0, count), each at least
+	// grain long, on the workers and the calling thread, and returns once all
+	// chunks are done. Rethrows the first exception thrown by fn. Safe to call from
+	// inside a task: the caller keeps taking chunks, so it never waits on a worker
+	// that is itself blocked.
+	template <typename Function>
+	void ParallelFor(size_t count, size_t grain, Function&& fn)
+	{
+		grain = std::max<size_t>(grain, 1);
+		size_t chunkCount = std::min(count / grain, (mThreadCount + 1) * 4);
+		if (chunkCount <= 1)
+		{
+			if (count > 0)
+			{
+				fn(size_t(0), count);
+			}
+			return;
+		}
+
+		// Helpers that start after every chunk is taken must not touch fn, which lives
+		// on the caller's stack; they only touch the shared state.
+		auto state = std::make_shared<ParallelForState>(chunkCount);
+		auto runChunks = [state, count, chunkCount, &fn]
+		{
+			size_t chunk;
+			while ((chunk = state->mNextChunk.fetch_add(1, std::memory_order_relaxed)) < chunkCount)
+			{
+				try
+				{
+					fn(chunk * count / chunkCount, (chunk + 1) * count / chunkCount);
+				}
+				catch (...)
+				{
+					std::lock_guard<std::mutex> lock(state->mErrorMutex);
+					if (!state->mError)
+					{
+						state->mError = std::current_exception();
+					}
+				}
+
+				if (state->mRemaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+				{
+					state->mRemaining.notify_all();
+				}
+			}
+		};
+
+		size_t helperCount = std::min(mThreadCount, chunkCount - 1);
+		for (size_t i = 0; i < helperCount; ++i)
+		{
+			Submit(runChunks);
+		}
+		runChunks();
+
+		size_t remaining;
+		while ((remaining = state->mRemaining.load(std::memory_order_acquire)) != 0)
+		{
+			state->mRemaining.wait(remaining, std::memory_order_acquire);
+		}
+
+		if (state->mError)
+		{
+			std::rethrow_exception(state->mError);
+		}
+	}
+
+	void Submit(Task task)
+	{
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			mTasks.Enqueue(std::move(task));
+		}
+		mCondition.notify_one();
+	}
+
+	size_t ThreadCount() const noexcept
+	{
+		return mThreadCount;
+	}
+
+private:
+	struct ParallelForState
+	{
+		explicit ParallelForState(size_t chunkCount)
+			: mNextChunk(0)
+			, mRemaining(chunkCount)
+		{
+		}
+
+		std::atomic<size_t> mNextChunk;
+		std::atomic<size_t> mRemaining;
+		std::mutex mErrorMutex;
+		std::exception_ptr mError;
+	};
+
+	void workerLoop()
+	{
+		for (;;)
+		{
+			Task task;
+			{
+				std::unique_lock<std::mutex> lock(mMutex);
+				mCondition.wait(lock, [this] { return mbStopping || !mTasks.IsEmpty(); });
+				if (!mTasks.TryPop(task))
+				{
+					return;
+				}
+			}
+			task();
+		}
+	}
+
+private:
+	std::unique_ptr<std::thread[]> mThreads;
+	const size_t mThreadCount;
+	Queue<Task> mTasks;
+	std::mutex mMutex;
+	std::condition_variable mCondition;
+	bool mbStopping;
+};
+
+} // namespace abouttt
@@ -0,0 +1,749 @@
+#pragma once
+
+#include <algorithm>
+#include <compare>
+#include <cstddef>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "Instrumentation.h"
+#include "Memory.h"
+#include "Simd.h"
+
+namespace abouttt
+{
+
+// Fills a node, links included, to about two cache lines.
+template <typename T>
+inline constexpr size_t DEFAULT_UNROLLED_NODE_CAPACITY =
+	std::max<size_t>(4, (2 * CACHE_LINE_SIZE - 2 * sizeof(void*) - sizeof(size_t)) / sizeof(T));
+
+template <typename T, size_t Capacity>
+class UnrolledLinkedListNode;
+
+template <typename T, size_t Capacity>
+class UnrolledLinkedListIterator;
+
+// Doubly linked list whose nodes each hold up to NodeCapacity elements in a small
+// contiguous array, so iteration and Find mostly walk sequential memory. Inserting
+// or removing shifts at most one node's elements; a full node is split in half and
+// a node that drops below half full absorbs its successor when they fit together.
+// Inserting or removing invalidates iterators into the nodes involved.
+template <typename T, typename Allocator = std::allocator<T>, size_t NodeCapacity = DEFAULT_UNROLLED_NODE_CAPACITY<T>>
+class UnrolledLinkedList
+{
+	static_assert(std::is_same_v<typename Allocator::value_type, T>, "Allocator::value_type must be T");
+	static_assert(NodeCapacity >= 2, "NodeCapacity must be at least 2");
+
+private:
+	using Node = UnrolledLinkedListNode<T, NodeCapacity>;
+	using NodeAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Node>;
+	using NodeAllocatorTraits = std::allocator_traits<NodeAllocator>;
+
+public:
+	using AllocatorType = Allocator;
+	using Iterator = UnrolledLinkedListIterator<T, NodeCapacity>;
+	using ConstIterator = UnrolledLinkedListIterator<const T, NodeCapacity>;
+
+public:
+	static constexpr size_t NODE_CAPACITY = NodeCapacity;
+
+public:
+	UnrolledLinkedList() noexcept
+		: UnrolledLinkedList(Allocator())
+	{
+	}
+
+	explicit UnrolledLinkedList(const Allocator& alloc) noexcept
+		: mAllocator(alloc)
+		, mHead(nullptr)
+		, mTail(nullptr)
+		, mCount(0)
+	{
+	}
+
+	UnrolledLinkedList(std::initializer_list<T> ilist, const Allocator& alloc = Allocator())
+		: UnrolledLinkedList(alloc)
+	{
+		for (const T& value : ilist)
+		{
+			AddTail(value);
+		}
+	}
+
+	UnrolledLinkedList(const UnrolledLinkedList& other)
+		: UnrolledLinkedList(other, Allocator(NodeAllocatorTraits::select_on_container_copy_construction(other.mAllocator)))
+	{
+	}
+
+	UnrolledLinkedList(const UnrolledLinkedList& other, const Allocator& alloc)
+		: UnrolledLinkedList(alloc)
+	{
+		for (const T& value : other)
+		{
+			AddTail(value);
+		}
+	}
+
+	UnrolledLinkedList(UnrolledLinkedList&& other) noexcept
+		: mAllocator(std::move(other.mAllocator))
+		, mHead(std::exchange(other.mHead, nullptr))
+		, mTail(std::exchange(other.mTail, nullptr))
+		, mCount(std::exchange(other.mCount, 0))
+	{
+	}
+
+	UnrolledLinkedList(UnrolledLinkedList&& other, const Allocator& alloc)
+		: UnrolledLinkedList(alloc)
+	{
+		if (mAllocator == other.mAllocator)
+		{
+			swapNodes(other);
+		}
+		else
+		{
+			for (T& value : other)
+			{
+				AddTail(std::move(value));
+			}
+			other.Clear();
+		}
+	}
+
+	~UnrolledLinkedList()
+	{
+		Clear();
+	}
+
+public:
+	UnrolledLinkedList& operator=(const UnrolledLinkedList& other)
+	{
+		if (this != &other)
+		{
+			if constexpr (NodeAllocatorTraits::propagate_on_container_copy_assignment::value)
+			{
+				if (mAllocator != other.mAllocator)
+				{
+					Clear();
+				}
+				mAllocator = other.mAllocator;
+			}
+			UnrolledLinkedList temp(other, GetAllocator());
+			swapNodes(temp);
+		}
+		return *this;
+	}
+
+	UnrolledLinkedList& operator=(UnrolledLinkedList&& other) noexcept(
+		NodeAllocatorTraits::propagate_on_container_move_assignment::value ||
+		NodeAllocatorTraits::is_always_equal::value)
+	{
+		if (this != &other)
+		{
+			if constexpr (NodeAllocatorTraits::propagate_on_container_move_assignment::value)
+			{
+				Clear();
+				mAllocator = std::move(other.mAllocator);
+				swapNodes(other);
+			}
+			else
+			{
+				UnrolledLinkedList temp(std::move(other), GetAllocator());
+				swapNodes(temp);
+			}
+		}
+		return *this;
+	}
+
+	UnrolledLinkedList& operator=(std::initializer_list<T> ilist)
+	{
+		UnrolledLinkedList temp(ilist, GetAllocator());
+		swapNodes(temp);
+		return *this;
+	}
+
+	auto operator<=>(const UnrolledLinkedList& other) const
+	{
+		ConstIterator a = begin();
+		ConstIterator b = other.begin();
+
+		while (a != end() && b != other.end())
+		{
+			if (auto cmp = *a <=> *b; cmp != 0)
+			{
+				return cmp;
+			}
+			++a;
+			++b;
+		}
+
+		return a == end() && b == other.end() ? std::strong_ordering::equal :
+			a == end() ? std::strong_ordering::less :
+			std::strong_ordering::greater;
+	}
+
+	bool operator==(const UnrolledLinkedList& other) const
+	{
+		if (mCount != other.mCount)
+		{
+			return false;
+		}
+
+		ConstIterator a = begin();
+		for (const T& value : other)
+		{
+			if (*a != value)
+			{
+				return false;
+			}
+			++a;
+		}
+
+		return true;
+	}
+
+public:
+	void AddHead(const T& value)
+	{
+		EmplaceHead(value);
+	}
+
+	void AddHead(T&& value)
+	{
+		EmplaceHead(std::move(value));
+	}
+
+	void AddTail(const T& value)
+	{
+		EmplaceTail(value);
+	}
+
+	void AddTail(T&& value)
+	{
+		EmplaceTail(std::move(value));
+	}
+
+	void Clear() noexcept
+	{
+		while (mHead)
+		{
+			Node* next = mHead->mNext;
+			destroyNode(mHead);
+			mHead = next;
+		}
+		mTail = nullptr;
+		mCount = 0;
+	}
+
+	bool Contains(const T& value) const
+	{
+		return Find(value) != end();
+	}
+
+	size_t Count() const noexcept
+	{
+		return mCount;
+	}
+
+	// Inserts before pos and returns an iterator to the new element.
+	template <typename... Args>
+	Iterator Emplace(ConstIterator pos, Args&&... args)
+	{
+		if (!pos.mNode)
+		{
+			EmplaceTail(std::forward<Args>(args)...);
+			return Iterator(mTail, mTail->mCount - 1);
+		}
+		return insertAt(pos.mNode, pos.mIndex, std::forward<Args>(args)...);
+	}
+
+	// Adding to a full end node starts a new node rather than splitting it, so
+	// lists built from either end stay densely packed.
+	template <typename... Args>
+	T& EmplaceHead(Args&&... args)
+	{
+		if (mHead && mHead->mCount < NodeCapacity)
+		{
+			return *insertAt(mHead, 0, std::forward<Args>(args)...);
+		}
+		return emplaceInNewNode(nullptr, std::forward<Args>(args)...);
+	}
+
+	template <typename... Args>
+	T& EmplaceTail(Args&&... args)
+	{
+		if (mTail && mTail->mCount < NodeCapacity)
+		{
+			return *insertAt(mTail, mTail->mCount, std::forward<Args>(args)...);
+		}
+		return emplaceInNewNode(mTail, std::forward<Args>(args)...);
+	}
+
+	Iterator Find(const T& value)
+	{
+		ConstIterator it = static_cast<const UnrolledLinkedList*>(this)->Find(value);
+		return Iterator(it.mNode, it.mIndex);
+	}
+
+	ConstIterator Find(const T& value) const
+	{
+		for (Node* node = mHead; node != nullptr; node = node->mNext)
+		{
+			size_t index;
+			if constexpr (IsSimdSearchableV<T>)
+			{
+				index = SimdSearch::Find(node->data(), node->mCount, value);
+			}
+			else
+			{
+				index = std::find(node->data(), node->data() + node->mCount, value) - node->data();
+			}
+
+			if (index != node->mCount)
+			{
+				return ConstIterator(node, index);
+			}
+		}
+		return end();
+	}
+
+	Iterator FindLast(const T& value)
+	{
+		ConstIterator it = static_cast<const UnrolledLinkedList*>(this)->FindLast(value);
+		return Iterator(it.mNode, it.mIndex);
+	}
+
+	ConstIterator FindLast(const T& value) const
+	{
+		for (Node* node = mTail; node != nullptr; node = node->mPrev)
+		{
+			if constexpr (IsSimdSearchableV<T>)
+			{
+				size_t index = SimdSearch::FindLast(node->data(), node->mCount, value);
+				if (index != node->mCount)
+				{
+					return ConstIterator(node, index);
+				}
+			}
+			else
+			{
+				for (size_t index = node->mCount; index-- > 0;)
+				{
+					if (node->data()[index] == value)
+					{
+						return ConstIterator(node, index);
+					}
+				}
+			}
+		}
+		return end();
+	}
+
+	Allocator GetAllocator() const noexcept
+	{
+		return Allocator(mAllocator);
+	}
+
+	Iterator Insert(ConstIterator pos, const T& value)
+	{
+		return Emplace(pos, value);
+	}
+
+	Iterator Insert(ConstIterator pos, T&& value)
+	{
+		return Emplace(pos, std::move(value));
+	}
+
+	bool IsEmpty() const noexcept
+	{
+		return mCount == 0;
+	}
+
+	bool Remove(const T& value)
+	{
+		Iterator it = Find(value);
+		if (it == end())
+		{
+			return false;
+		}
+		Remove(it);
+		return true;
+	}
+
+	// Removes the element at pos and returns an iterator to the element after it.
+	Iterator Remove(ConstIterator pos)
+	{
+		return eraseAt(pos.mNode, pos.mIndex);
+	}
+
+	void Swap(UnrolledLinkedList& other) noexcept
+	{
+		if constexpr (NodeAllocatorTraits::propagate_on_container_swap::value)
+		{
+			std::swap(mAllocator, other.mAllocator);
+		}
+		swapNodes(other);
+	}
+
+public: // Iterators for range-based loop support.
+	Iterator begin() noexcept
+	{
+		return Iterator(mHead, 0);
+	}
+
+	ConstIterator begin() const noexcept
+	{
+		return ConstIterator(mHead, 0);
+	}
+
+	Iterator end() noexcept
+	{
+		return Iterator(nullptr, 0);
+	}
+
+	ConstIterator end() const noexcept
+	{
+		return ConstIterator(nullptr, 0);
+	}
+
+private:
+	Node* createNode()
+	{
+		Node* node = NodeAllocatorTraits::allocate(mAllocator, 1);
+		std::construct_at(node);
+		ABOUTTT_INSTRUMENT(NodeAllocate, "UnrolledLinkedList", this, sizeof(Node), 1);
+		return node;
+	}
+
+	void destroyNode(Node* node) noexcept
+	{
+		std::destroy_at(node);
+		NodeAllocatorTraits::deallocate(mAllocator, node, 1);
+		ABOUTTT_INSTRUMENT(NodeFree, "UnrolledLinkedList", this, sizeof(Node), 1);
+	}
+
+	// Links in a node holding just the new element after prev, or at the head when
+	// prev is null.
+	template <typename... Args>
+	T& emplaceInNewNode(Node* prev, Args&&... args)
+	{
+		Node* node = createNode();
+		try
+		{
+			std::construct_at(node->data(), std::forward<Args>(args)...);
+		}
+		catch (...)
+		{
+			destroyNode(node);
+			throw;
+		}
+		node->mCount = 1;
+		linkAfter(prev, node);
+		++mCount;
+		return *node->data();
+	}
+
+	// Links node in after prev, or at the head when prev is null.
+	void linkAfter(Node* prev, Node* node) noexcept
+	{
+		Node* next = prev ? prev->mNext : mHead;
+		node->mPrev = prev;
+		node->mNext = next;
+		(prev ? prev->mNext : mHead) = node;
+		(next ? next->mPrev : mTail) = node;
+	}
+
+	void unlink(Node* node) noexcept
+	{
+		(node->mPrev ? node->mPrev->mNext : mHead) = node->mNext;
+		(node->mNext ? node->mNext->mPrev : mTail) = node->mPrev;
+	}
+
+	// Moves count elements from the front of source's range to dest, which must be
+	// uninitialized, and ends their lifetime in source.
+	static void relocate(T* source, size_t count, T* dest) noexcept
+	{
+		if constexpr (IsTriviallyRelocatableV<T>)
+		{
+			if (count > 0)
+			{
+				std::memcpy(static_cast<void*>(dest), static_cast<const void*>(source), sizeof(T) * count);
+			}
+		}
+		else
+		{
+			std::uninitialized_move_n(source, count, dest);
+			std::destroy_n(source, count);
+		}
+	}
+
+	template <typename... Args>
+	Iterator insertAt(Node* node, size_t index, Args&&... args)
+	{
+		if (index == node->mCount && index < NodeCapacity)
+		{
+			std::construct_at(node->data() + index, std::forward<Args>(args)...);
+			++node->mCount;
+			++mCount;
+			return Iterator(node, index);
+		}
+
+		// Built before anything moves, so that args may refer to an element of this
+		// list and a throwing constructor leaves it untouched.
+		T value(std::forward<Args>(args)...);
+
+		if (node->mCount == NodeCapacity)
+		{
+			Node* next = createNode();
+			linkAfter(node, next);
+			constexpr size_t half = NodeCapacity / 2;
+			relocate(node->data() + half, NodeCapacity - half, next->data());
+			next->mCount = NodeCapacity - half;
+			node->mCount = half;
+			if (index > half)
+			{
+				node = next;
+				index -= half;
+			}
+		}
+
+		T* data = node->data();
+		size_t count = node->mCount;
+		if (index < count)
+		{
+			if constexpr (IsTriviallyRelocatableV<T>)
+			{
+				std::memmove(static_cast<void*>(data + index + 1), static_cast<const void*>(data + index), sizeof(T) * (count - index));
+				try
+				{
+					std::construct_at(data + index, std::move(value));
+				}
+				catch (...)
+				{
+					std::memmove(static_cast<void*>(data + index), static_cast<const void*>(data + index + 1), sizeof(T) * (count - index));
+					throw;
+				}
+			}
+			else
+			{
+				std::construct_at(data + count, std::move(data[count - 1]));
+				++node->mCount;
+				++mCount;
+				std::move_backward(data + index, data + count - 1, data + count);
+				data[index] = std::move(value);
+				return Iterator(node, index);
+			}
+		}
+		else
+		{
+			std::construct_at(data + index, std::move(value));
+		}
+		++node->mCount;
+		++mCount;
+
+		return Iterator(node, index);
+	}
+
+	Iterator eraseAt(Node* node, size_t index)
+	{
+		T* data = node->data();
+		size_t count = node->mCount;
+		if constexpr (IsTriviallyRelocatableV<T>)
+		{
+			std::destroy_at(data + index);
+			std::memmove(static_cast<void*>(data + index), static_cast<const void*>(data + index + 1), sizeof(T) * (count - index - 1));
+		}
+		else
+		{
+			std::move(data + index + 1, data + count, data + index);
+			std::destroy_at(data + count - 1);
+		}
+		--node->mCount;
+		--mCount;
+
+		Node* next = node->mNext;
+		if (node->mCount == 0)
+		{
+			unlink(node);
+			destroyNode(node);
+			return Iterator(next, 0);
+		}
+
+		if (next && node->mCount < NodeCapacity / 2 && node->mCount + next->mCount <= NodeCapacity)
+		{
+			relocate(next->data(), next->mCount, data + node->mCount);
+			node->mCount += next->mCount;
+			next->mCount = 0;
+			unlink(next);
+			destroyNode(next);
+		}
+
+		if (index < node->mCount)
+		{
+			return Iterator(node, index);
+		}
+		return Iterator(node->mNext, 0);
+	}
+
+	void swapNodes(UnrolledLinkedList& other) noexcept
+	{
+		std::swap(mHead, other.mHead);
+		std::swap(mTail, other.mTail);
+		std::swap(mCount, other.mCount);
+	}
+
+private:
+	[[no_unique_address]] NodeAllocator mAllocator;
+	Node* mHead;
+	Node* mTail;
+	size_t mCount;
+};
+
+template <typename T, size_t Capacity>
+class UnrolledLinkedListNode
+{
+public:
+	template <typename, typename, size_t>
+	friend class UnrolledLinkedList;
+	friend class UnrolledLinkedListIterator<T, Capacity>;
+	friend class UnrolledLinkedListIterator<const T, Capacity>;
+
+public:
+	UnrolledLinkedListNode() noexcept
+		: mNext(nullptr)
+		, mPrev(nullptr)
+		, mCount(0)
+	{
+	}
+
+	UnrolledLinkedListNode(const UnrolledLinkedListNode&) = delete;
+
+	~UnrolledLinkedListNode()
+	{
+		std::destroy_n(data(), mCount);
+	}
+
+public:
+	UnrolledLinkedListNode& operator=(const UnrolledLinkedListNode&) = delete;
+
+private:
+	T* data() noexcept
+	{
+		return std::launder(reinterpret_cast<T*>(mStorage));
+	}
+
+private:
+	UnrolledLinkedListNode* mNext;
+	UnrolledLinkedListNode* mPrev;
+	size_t mCount;
+	alignas(T) std::byte mStorage[sizeof(T) * Capacity];
+};
+
+template <typename T, size_t Capacity>
+class UnrolledLinkedListIterator
+{
+private:
+	using Node = UnrolledLinkedListNode<std::remove_const_t<T>, Capacity>;
+
+public:
+	template <typename, typename, size_t>
+	friend class UnrolledLinkedList;
+	friend class UnrolledLinkedListIterator<const T, Capacity>;
+
+public:
+	using iterator_category = std::bidirectional_iterator_tag;
+	using value_type = std::remove_cv_t<T>;
+	using difference_type = std::ptrdiff_t;
+	using pointer = T*;
+	using reference = T&;
+
+public:
+	UnrolledLinkedListIterator() noexcept
+		: mNode(nullptr)
+		, mIndex(0)
+	{
+	}
+
+	UnrolledLinkedListIterator(Node* node, size_t index) noexcept
+		: mNode(node)
+		, mIndex(index)
+	{
+	}
+
+	template<typename U = T, typename = std::enable_if_t<std::is_const_v<U>>>
+	UnrolledLinkedListIterator(const UnrolledLinkedListIterator<std::remove_const_t<T>, Capacity>& other) noexcept
+		: mNode(other.mNode)
+		, mIndex(other.mIndex)
+	{
+	}
+
+public:
+	T& operator*() const noexcept
+	{
+		return mNode->data()[mIndex];
+	}
+
+	T* operator->() const noexcept
+	{
+		return mNode->data() + mIndex;
+	}
+
+	UnrolledLinkedListIterator& operator++() noexcept
+	{
+		if (mNode && ++mIndex == mNode->mCount)
+		{
+			mNode = mNode->mNext;
+			mIndex = 0;
+		}
+		return *this;
+	}
+
+	UnrolledLinkedListIterator operator++(int) noexcept
+	{
+		UnrolledLinkedListIterator temp(*this);
+		++(*this);
+		return temp;
+	}
+
+	UnrolledLinkedListIterator& operator--() noexcept
+	{
+		if (mIndex > 0)
+		{
+			--mIndex;
+		}
+		else if (mNode)
+		{
+			mNode = mNode->mPrev;
+			mIndex = mNode ? mNode->mCount - 1 : 0;
+		}
+		return *this;
+	}
+
+	UnrolledLinkedListIterator operator--(int) noexcept
+	{
+		UnrolledLinkedListIterator temp(*this);
+		--(*this);
+		return temp;
+	}
+
+	bool operator==(const UnrolledLinkedListIterator& other) const noexcept
+	{
+		return mNode == other.mNode && mIndex == other.mIndex;
+	}
+
+	bool operator!=(const UnrolledLinkedListIterator& other) const noexcept
+	{
+		return !(*this == other);
+	}
+
+private:
+	Node* mNode;
+	size_t mIndex;
+};
+
+} // namespace abouttt
@@ -0,0 +1,247 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+
+#include "GrowthPolicy.h"
+#include "Instrumentation.h"
+#include "Memory.h"
+
+namespace abouttt
+{
+
+// Unbounded Chase-Lev work-stealing deque, with the memory orderings of Lê et al.,
+// "Correct and Efficient Work-Stealing for Weak Memory Models". One owner thread
+// calls Push and TryPop at the bottom, LIFO like a Stack; any number of thieves
+// call TrySteal at the top. Only the owner ever writes the bottom index, so its
+// operations need no atomic read-modify-write except when racing a thief for the
+// last element.
+//
+// The ring grows through Growth, rounded up to a power of two. A thief may still
+// be reading the old ring, so it is retired rather than freed and released with
+// the deque; all retired rings together are smaller than the current one.
+// T is copied in and out of slots with relaxed atomics, so it must be trivially
+// copyable, typically a pointer or a task handle.
+template <typename T, typename Allocator = std::allocator<T>, typename Growth = DefaultGrowth>
+class WorkStealingDeque
+{
+	static_assert(std::is_same_v<typename Allocator::value_type, T>, "Allocator::value_type must be T");
+	static_assert(std::is_trivially_copyable_v<T>, "WorkStealingDeque requires a trivially copyable T");
+
+private:
+	using Slot = std::atomic<T>;
+
+	struct Ring
+	{
+		size_t mCapacity;
+		Slot* mSlots;
+		Ring* mRetired;
+
+		Slot& At(int64_t index) noexcept
+		{
+			return mSlots[static_cast<size_t>(index) & (mCapacity - 1)];
+		}
+	};
+
+	using SlotAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Slot>;
+	using SlotAllocatorTraits = std::allocator_traits<SlotAllocator>;
+	using RingAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Ring>;
+	using RingAllocatorTraits = std::allocator_traits<RingAllocator>;
+
+public:
+	using AllocatorType = Allocator;
+
+public:
+	WorkStealingDeque()
+		: WorkStealingDeque(0)
+	{
+	}
+
+	explicit WorkStealingDeque(size_t capacity, const Allocator& alloc = Allocator())
+		: mAllocator(alloc)
+		, mTop(0)
+		, mBottom(0)
+		, mRing(createRing(std::bit_ceil(Growth::Grow(0, std::max<size_t>(capacity, 1), sizeof(T))), nullptr))
+	{
+	}
+
+	WorkStealingDeque(const WorkStealingDeque&) = delete;
+
+	// No other thread may be using the deque.
+	~WorkStealingDeque()
+	{
+		Ring* ring = mRing.load(std::memory_order_relaxed);
+		while (ring)
+		{
+			Ring* retired = ring->mRetired;
+			destroyRing(ring);
+			ring = retired;
+		}
+	}
+
+public:
+	WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+public:
+	// Owner only.
+	size_t Capacity() const noexcept
+	{
+		return mRing.load(std::memory_order_relaxed)->mCapacity;
+	}
+
+	// Approximate while other threads are operating on the deque.
+	size_t Count() const noexcept
+	{
+		int64_t bottom = mBottom.load(std::memory_order_acquire);
+		int64_t top = mTop.load(std::memory_order_acquire);
+		return bottom > top ? static_cast<size_t>(bottom - top) : 0;
+	}
+
+	Allocator GetAllocator() const noexcept
+	{
+		return Allocator(mAllocator);
+	}
+
+	bool IsEmpty() const noexcept
+	{
+		return Count() == 0;
+	}
+
+	// Owner only.
+	void Push(const T& value)
+	{
+		int64_t bottom = mBottom.load(std::memory_order_relaxed);
+		int64_t top = mTop.load(std::memory_order_acquire);
+		Ring* ring = mRing.load(std::memory_order_relaxed);
+		if (static_cast<size_t>(bottom - top) >= ring->mCapacity)
+		{
+			ring = grow(ring, top, bottom, ring->mCapacity + 1);
+		}
+		ring->At(bottom).store(value, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		mBottom.store(bottom + 1, std::memory_order_relaxed);
+	}
+
+	// Owner only. Grows the ring so that it holds newCapacity elements.
+	void Reserve(size_t newCapacity)
+	{
+		Ring* ring = mRing.load(std::memory_order_relaxed);
+		if (newCapacity > ring->mCapacity)
+		{
+			grow(ring, mTop.load(std::memory_order_acquire), mBottom.load(std::memory_order_relaxed), newCapacity);
+		}
+	}
+
+	// Owner only. Takes the most recently pushed element.
+	bool TryPop(T& outValue) noexcept
+	{
+		int64_t bottom = mBottom.load(std::memory_order_relaxed) - 1;
+		Ring* ring = mRing.load(std::memory_order_relaxed);
+		mBottom.store(bottom, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		int64_t top = mTop.load(std::memory_order_relaxed);
+
+		if (top > bottom)
+		{
+			mBottom.store(bottom + 1, std::memory_order_relaxed);
+			return false;
+		}
+
+		T value = ring->At(bottom).load(std::memory_order_relaxed);
+		if (top == bottom)
+		{
+			// The last element: whoever advances the top first gets it.
+			bool bWon = mTop.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+			mBottom.store(bottom + 1, std::memory_order_relaxed);
+			if (!bWon)
+			{
+				return false;
+			}
+		}
+		outValue = value;
+		return true;
+	}
+
+	// Any thread. Takes the least recently pushed element; returns false when the
+	// deque is empty or when another thread took that element first.
+	bool TrySteal(T& outValue) noexcept
+	{
+		int64_t top = mTop.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		int64_t bottom = mBottom.load(std::memory_order_acquire);
+		if (top >= bottom)
+		{
+			return false;
+		}
+
+		Ring* ring = mRing.load(std::memory_order_acquire);
+		T value = ring->At(top).load(std::memory_order_relaxed);
+		if (!mTop.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+		{
+			return false;
+		}
+		outValue = value;
+		return true;
+	}
+
+private:
+	Ring* createRing(size_t capacity, Ring* retired)
+	{
+		RingAllocator ringAllocator(mAllocator);
+		Ring* ring = RingAllocatorTraits::allocate(ringAllocator, 1);
+		Slot* slots;
+		try
+		{
+			slots = SlotAllocatorTraits::allocate(mAllocator, capacity);
+		}
+		catch (...)
+		{
+			RingAllocatorTraits::deallocate(ringAllocator, ring, 1);
+			throw;
+		}
+		std::uninitialized_default_construct_n(slots, capacity);
+		std::construct_at(ring, Ring{ capacity, slots, retired });
+		return ring;
+	}
+
+	void destroyRing(Ring* ring) noexcept
+	{
+		SlotAllocatorTraits::deallocate(mAllocator, ring->mSlots, ring->mCapacity);
+		RingAllocator ringAllocator(mAllocator);
+		RingAllocatorTraits::deallocate(ringAllocator, ring, 1);
+	}
+
+	// Copies the live range [top, bottom) into a larger ring and publishes it.
+	Ring* grow(Ring* ring, int64_t top, int64_t bottom, size_t minCapacity)
+	{
+		size_t newCapacity = std::bit_ceil(Growth::Grow(ring->mCapacity, minCapacity, sizeof(T)));
+		Ring* newRing = createRing(newCapacity, ring);
+		for (int64_t i = top; i < bottom; ++i)
+		{
+			newRing->At(i).store(ring->At(i).load(std::memory_order_relaxed), std::memory_order_relaxed);
+		}
+		mRing.store(newRing, std::memory_order_release);
+
+		size_t used = sizeof(T) * static_cast<size_t>(bottom - top);
+		RecordReallocation<Growth>(sizeof(T) * ring->mCapacity, sizeof(T) * newCapacity, used, used);
+		ABOUTTT_INSTRUMENT(Reallocate, "WorkStealingDeque", this, used, sizeof(T) * newCapacity);
+		return newRing;
+	}
+
+private:
+	[[no_unique_address]] SlotAllocator mAllocator;
+
+	// Advanced by thieves, and by the owner when racing them for the last element.
+	alignas(CACHE_LINE_SIZE) std::atomic<int64_t> mTop;
+
+	// Written by the owner only.
+	alignas(CACHE_LINE_SIZE) std::atomic<int64_t> mBottom;
+	std::atomic<Ring*> mRing;
+};
+
+} // namespace abouttt
@@ -0,0 +1,296 @@
+#include <algorithm>
+#include <vector>
+
+#include "Array.h"
+#include "BenchmarkUtils.h"
+#include "EytzingerArray.h"
+#include "InlineArray.h"
+
+namespace abouttt
+{
+namespace
+{
+
+template <typename T>
+using SmallArray = InlineArray<T, 16>;
+
+template <typename C>
+struct ArrayTraits;
+
+template <typename T, typename Allocator, typename Growth, size_t N>
+struct ArrayTraits<Array<T, Allocator, Growth, N>>
+{
+	using C = Array<T, Allocator, Growth, N>;
+	using ValueType = T;
+
+	static bool Contains(const C& c, const T& value)
+	{
+		return c.Contains(value);
+	}
+
+	static void Erase(C& c, size_t index)
+	{
+		c.RemoveAt(index);
+	}
+
+	static void Insert(C& c, size_t index, const T& value)
+	{
+		c.Insert(index, value);
+	}
+
+	static void Pop(C& c)
+	{
+		c.RemoveAt(c.Count() - 1);
+	}
+
+	static void Push(C& c, const T& value)
+	{
+		c.Add(value);
+	}
+
+	static void Reserve(C& c, size_t count)
+	{
+		c.Reserve(count);
+	}
+};
+
+template <typename T>
+struct ArrayTraits<std::vector<T>>
+{
+	using C = std::vector<T>;
+	using ValueType = T;
+
+	static bool Contains(const C& c, const T& value)
+	{
+		return std::find(c.begin(), c.end(), value) != c.end();
+	}
+
+	static void Erase(C& c, size_t index)
+	{
+		c.erase(c.begin() + index);
+	}
+
+	static void Insert(C& c, size_t index, const T& value)
+	{
+		c.insert(c.begin() + index, value);
+	}
+
+	static void Pop(C& c)
+	{
+		c.pop_back();
+	}
+
+	static void Push(C& c, const T& value)
+	{
+		c.push_back(value);
+	}
+
+	static void Reserve(C& c, size_t count)
+	{
+		c.reserve(count);
+	}
+};
+
+template <typename C>
+C makeFilled(const std::vector<typename ArrayTraits<C>::ValueType>& values)
+{
+	C c;
+	ArrayTraits<C>::Reserve(c, values.size());
+	for (const auto& value : values)
+	{
+		ArrayTraits<C>::Push(c, value);
+	}
+	return c;
+}
+
+// Push n elements into reserved storage, then pop them all.
+template <typename C>
+void BM_PushPop(benchmark::State& state)
+{
+	using Traits = ArrayTraits<C>;
+	using T = typename Traits::ValueType;
+	size_t n = static_cast<size_t>(state.range(0));
+	std::vector<T> values = MakeValues<T>(n);
+	C c;
+	Traits::Reserve(c, n);
+	for (auto _ : state)
+	{
+		for (const T& value : values)
+		{
+			Traits::Push(c, value);
+		}
+		for (size_t i = 0; i < n; ++i)
+		{
+			Traits::Pop(c);
+		}
+		benchmark::ClobberMemory();
+	}
+	SetProcessed(state, 2 * n, sizeof(T));
+}
+
+// Push n elements into an empty container, paying for every reallocation.
+template <typename C>
+void BM_Grow(benchmark::State& state)
+{
+	using Traits = ArrayTraits<C>;
+	using T = typename Traits::ValueType;
+	size_t n = static_cast<size_t>(state.range(0));
+	std::vector<T> values = MakeValues<T>(n);
+	for (auto _ : state)
+	{
+		C c;
+		for (const T& value : values)
+		{
+			Traits::Push(c, value);
+		}
+		benchmark::DoNotOptimize(&c);
+	}
+	SetProcessed(state, n, sizeof(T));
+}
+
+// One insert and one erase in the middle of n elements.
+template <typename C>
+void BM_InsertErase(benchmark::State& state)
+{
+	using Traits = ArrayTraits<C>;
+	using T = typename Traits::ValueType;
+	size_t n = static_cast<size_t>(state.range(0));
+	C c = makeFilled<C>(MakeValues<T>(n));
+	Traits::Reserve(c, n + 1);
+	T value = MakeValue<T>(n);
+	for (auto _ : state)
+	{
+		Traits::Insert(c, n / 2, value);
+		Traits::Erase(c, n / 2);
+		benchmark::ClobberMemory();
+	}
+	SetProcessed(state, 2, sizeof(T));
+}
+
+// Linear search for a missing value.
+template <typename C>
+void BM_Find(benchmark::State& state)
+{
+	using Traits = ArrayTraits<C>;
+	using T = typename Traits::ValueType;
+	size_t n = static_cast<size_t>(state.range(0));
+	C c = makeFilled<C>(MakeValues<T>(n));
+	T missing = MakeValue<T>(n);
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(Traits::Contains(c, missing));
+	}
+	SetProcessed(state, n, sizeof(T));
+}
+
+template <typename C>
+void BM_Iterate(benchmark::State& state)
+{
+	using Traits = ArrayTraits<C>;
+	using T = typename Traits::ValueType;
+	size_t n = static_cast<size_t>(state.range(0));
+	C c = makeFilled<C>(MakeValues<T>(n));
+	for (auto _ : state)
+	{
+		size_t sum = 0;
+		for (const T& value : c)
+		{
+			sum += Weight(value);
+		}
+		benchmark::DoNotOptimize(sum);
+	}
+	SetProcessed(state, n, sizeof(T));
+}
+
+// Lookups per iteration of the BM_LowerBound benchmarks, cycling through random
+// keys so that large tables miss the cache.
+constexpr size_t LOWER_BOUND_QUERIES = 1024;
+
+template <typename T>
+void BM_LowerBound_Array(benchmark::State& state)
+{
+	size_t n = static_cast<size_t>(state.range(0));
+	std::vector<T> values = MakeValues<T>(n);
+	Array<T> c;
+	c.Append(values.data(), values.size());
+	std::vector<T> queries = MakeShuffledValues<T>(std::max(n, LOWER_BOUND_QUERIES));
+	queries.resize(LOWER_BOUND_QUERIES);
+	for (auto _ : state)
+	{
+		size_t sum = 0;
+		for (const T& query : queries)
+		{
+			sum += c.LowerBound(query);
+		}
+		benchmark::DoNotOptimize(sum);
+	}
+	SetProcessed(state, LOWER_BOUND_QUERIES, sizeof(T));
+}
+
+template <typename T>
+void BM_LowerBound_EytzingerArray(benchmark::State& state)
+{
+	size_t n = static_cast<size_t>(state.range(0));
+	std::vector<T> values = MakeValues<T>(n);
+	EytzingerArray<T> c(values.data(), values.size());
+	std::vector<T> queries = MakeShuffledValues<T>(std::max(n, LOWER_BOUND_QUERIES));
+	queries.resize(LOWER_BOUND_QUERIES);
+	for (auto _ : state)
+	{
+		size_t sum = 0;
+		for (const T& query : queries)
+		{
+			const T* element = c.LowerBound(query);
+			sum += element ? Weight(*element) : 0;
+		}
+		benchmark::DoNotOptimize(sum);
+	}
+	SetProcessed(state, LOWER_BOUND_QUERIES, sizeof(T));
+}
+
+template <typename T>
+void BM_LowerBound_StdVector(benchmark::State& state)
+{
+	size_t n = static_cast<size_t>(state.range(0));
+	std::vector<T> c = MakeValues<T>(n);
+	std::vector<T> queries = MakeShuffledValues<T>(std::max(n, LOWER_BOUND_QUERIES));
+	queries.resize(LOWER_BOUND_QUERIES);
+	for (auto _ : state)
+	{
+		size_t sum = 0;
+		for (const T& query : queries)
+		{
+			sum += static_cast<size_t>(std::lower_bound(c.begin(), c.end(), query) - c.begin());
+		}
+		benchmark::DoNotOptimize(sum);
+	}
+	SetProcessed(state, LOWER_BOUND_QUERIES, sizeof(T));
+}
+
+#define ABOUTTT_ARRAY_BENCHMARKS(T) \
+	BENCHMARK_TEMPLATE(BM_PushPop, Array<T>)->Apply(BenchmarkSizes<T>); \
+	BENCHMARK_TEMPLATE(BM_PushPop, SmallArray<T>)->Apply(BenchmarkSizes<T>); \
+	BENCHMARK_TEMPLATE(BM_PushPop, std::vector<T>)->Apply(BenchmarkSizes<T>); \
+	BENCHMARK_TEMPLATE(BM_Grow, Array<T>)->Apply(BenchmarkSizes<T>); \
+	BENCHMARK_TEMPLATE(BM_Grow, SmallArray<T>)->Apply(BenchmarkSizes<T>); \
+	BENCHMARK_TEMPLATE(BM_Grow, std::vector<T>)->Apply(BenchmarkSizes<T>); \
+	BENCHMARK_TEMPLATE(BM_InsertErase, Array<T>)->Apply(BenchmarkSizes<T>); \
+	BENCHMARK_TEMPLATE(BM_InsertErase, std::vector<T>)->Apply(BenchmarkSizes<T>); \
+	BENCHMARK_TEMPLATE(BM_Find, Array<T>)->Apply(BenchmarkSizes<T>); \
+	BENCHMARK_TEMPLATE(BM_Find, std::vector<T>)->Apply(BenchmarkSizes<T>); \
+	BENCHMARK_TEMPLATE(BM_Iterate, Array<T>)->Apply(BenchmarkSizes<T>); \
+	BENCHMARK_TEMPLATE(BM_Iterate, std::vector<T>)->Apply(BenchmarkSizes<T>); \
+	BENCHMARK_TEMPLATE(BM_LowerBound_Array, T)->Apply(BenchmarkSizes<T>); \
+	BENCHMARK_TEMPLATE(BM_LowerBound_EytzingerArray, T)->Apply(BenchmarkSizes<T>); \
+	BENCHMARK_TEMPLATE(BM_LowerBound_StdVector, T)->Apply(BenchmarkSizes<T>)
+
+ABOUTTT_ARRAY_BENCHMARKS(Small);
+ABOUTTT_ARRAY_BENCHMARKS(Medium);
+ABOUTTT_ARRAY_BENCHMARKS(String);
+
+BENCHMARK_TEMPLATE(BM_LowerBound_Array, uint64_t)->Apply(BenchmarkSizes<uint64_t>);
+BENCHMARK_TEMPLATE(BM_LowerBound_EytzingerArray, uint64_t)->Apply(BenchmarkSizes<uint64_t>);
+BENCHMARK_TEMPLATE(BM_LowerBound_StdVector, uint64_t)->Apply(BenchmarkSizes<uint64_t>);
+
+} // namespace
+} // namespace abouttt
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <algorithm>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#ifndef ABOUTTT_BENCHMARK_MAX_SIZE
+#define ABOUTTT_BENCHMARK_MAX_SIZE 100000000
+#endif
+
+#ifndef ABOUTTT_BENCHMARK_MAX_BYTES
+#define ABOUTTT_BENCHMARK_MAX_BYTES (size_t(1) << 30)
+#endif
+
+namespace abouttt
+{
+
+// 64-byte element, ordered and compared by its key only.
+struct Medium
+{
+	uint64_t mKey;
+	uint64_t mPayload[7];
+
+	friend bool operator==(const Medium& lhs, const Medium& rhs) noexcept
+	{
+		return lhs.mKey == rhs.mKey;
+	}
+
+	friend auto operator<=>(const Medium& lhs, const Medium& rhs) noexcept
+	{
+		return lhs.mKey <=> rhs.mKey;
+	}
+};
+
+using Small = int32_t;
+using String = std::string;
+
+static_assert(sizeof(Small) == 4);
+static_assert(sizeof(Medium) == 64);
+
+// Distinct values for distinct i. Strings are long enough to defeat the small
+// string optimization, so every copy allocates.
+template <typename T>
+T MakeValue(size_t i)
+{
+	if constexpr (std::is_same_v<T, String>)
+	{
+		String value = std::to_string(i);
+		value.insert(0, 32 - value.size(), '0');
+		return value;
+	}
+	else if constexpr (std::is_same_v<T, Medium>)
+	{
+		return Medium{ i, {} };
+	}
+	else
+	{
+		return static_cast<T>(i);
+	}
+}
+
+// A stand-in for per-element work when iterating.
+template <typename T>
+size_t Weight(const T& value) noexcept
+{
+	if constexpr (std::is_same_v<T, String>)
+	{
+		return value.size();
+	}
+	else if constexpr (std::is_same_v<T, Medium>)
+	{
+		return value.mKey;
+	}
+	else
+	{
+		return static_cast<size_t>(value);
+	}
+}
+
+template <typename T>
+std::vector<T> MakeValues(size_t count)
+{
+	std::vector<T> values;
+	values.reserve(count);
+	for (size_t i = 0; i < count; ++i)
+	{
+		values.push_back(MakeValue<T>(i));
+	}
+	return values;
+}
+
+// The same values in an order fixed across runs.
+template <typename T>
+std::vector<T> MakeShuffledValues(size_t count)
+{
+	std::vector<T> values = MakeValues<T>(count);
+	std::shuffle(values.begin(), values.end(), std::mt19937_64(count));
+	return values;
+}
+
+// Largest size that keeps the container and its source values within the budget.
+template <typename T>
+size_t MaxBenchmarkSize() noexcept
+{
+	size_t footprint = sizeof(T) + (std::is_same_v<T, String> ? 48 : 0);
+	return std::min<size_t>(ABOUTTT_BENCHMARK_MAX_SIZE, ABOUTTT_BENCHMARK_MAX_BYTES / (2 * footprint));
+}
+
+// Registers the sizes 10, 100, ... up to MaxBenchmarkSize<T>().
+template <typename T>
+void BenchmarkSizes(benchmark::internal::Benchmark* benchmark)
+{
+	benchmark->ArgName("n");
+	for (size_t n = 10; n <= MaxBenchmarkSize<T>(); n *= 10)
+	{
+		benchmark->Arg(static_cast<int64_t>(n));
+	}
+}
+
+inline void SetProcessed(benchmark::State& state, size_t itemsPerIteration, size_t elementSize)
+{
+	state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * itemsPerIteration));
+	state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * itemsPerIteration * elementSize));
+}
+
+} // namespace abouttt
@@ -0,0 +1,417 @@
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "BenchmarkUtils.h"
+#include "ConcurrentPriorityQueue.h"
+#include "MpmcQueue.h"
+#include "SpinWait.h"
+#include "SpscQueue.h"
+#include "Stack.h"
+#include "WorkStealingDeque.h"
+
+namespace abouttt
+{
+namespace
+{
+
+constexpr size_t QUEUE_CAPACITY = 1024;
+
+// Mutex-protected std containers, the baseline for the concurrent queues.
+class LockedQueue
+{
+public:
+	void Dequeue(uint64_t& outValue)
+	{
+		for (;;)
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			if (!mQueue.empty())
+			{
+				outValue = mQueue.front();
+				mQueue.pop();
+				return;
+			}
+		}
+	}
+
+	void Enqueue(uint64_t value)
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mQueue.push(value);
+	}
+
+private:
+	std::mutex mMutex;
+	std::queue<uint64_t> mQueue;
+};
+
+class LockedPriorityQueue
+{
+public:
+	void Enqueue(uint64_t value)
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mQueue.push(value);
+	}
+
+	bool TryPop(uint64_t& outValue)
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		if (mQueue.empty())
+		{
+			return false;
+		}
+		outValue = mQueue.top();
+		mQueue.pop();
+		return true;
+	}
+
+private:
+	std::mutex mMutex;
+	std::priority_queue<uint64_t> mQueue;
+};
+
+// Mutex-protected Stack, the baseline for WorkStealingDeque. Thieves take from
+// the same end as the owner.
+class LockedStack
+{
+public:
+	void Push(uint32_t value)
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mStack.Push(value);
+	}
+
+	bool TryPop(uint32_t& outValue)
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		return mStack.TryPop(outValue);
+	}
+
+	bool TrySteal(uint32_t& outValue)
+	{
+		return TryPop(outValue);
+	}
+
+private:
+	std::mutex mMutex;
+	Stack<uint32_t> mStack;
+};
+
+template <typename Q>
+Q* makeQueue()
+{
+	return new Q();
+}
+
+template <>
+MpmcQueue<uint64_t>* makeQueue<MpmcQueue<uint64_t>>()
+{
+	return new MpmcQueue<uint64_t>(QUEUE_CAPACITY);
+}
+
+template <typename Q>
+void spinEnqueue(Q& queue, uint64_t value)
+{
+	SpinWait wait{ WaitPolicy() };
+	while (!queue.TryEnqueue(value))
+	{
+		wait.SpinOnce();
+	}
+}
+
+template <typename Q>
+uint64_t spinDequeue(Q& queue)
+{
+	SpinWait wait{ WaitPolicy() };
+	uint64_t value;
+	while (!queue.TryDequeue(value))
+	{
+		wait.SpinOnce();
+	}
+	return value;
+}
+
+// Ping-pong between the benchmark thread and an echo thread through two
+// SpscQueues; one iteration is one round trip.
+void BM_SpscRoundTrip(benchmark::State& state)
+{
+	SpscQueue<uint64_t> ping(QUEUE_CAPACITY);
+	SpscQueue<uint64_t> pong(QUEUE_CAPACITY);
+	std::thread echo([&]
+	{
+		uint64_t value;
+		while ((value = spinDequeue(ping)) != UINT64_MAX)
+		{
+			spinEnqueue(pong, value);
+		}
+	});
+
+	uint64_t i = 0;
+	for (auto _ : state)
+	{
+		spinEnqueue(ping, i++);
+		benchmark::DoNotOptimize(spinDequeue(pong));
+	}
+	spinEnqueue(ping, UINT64_MAX);
+	echo.join();
+	state.SetItemsProcessed(state.iterations());
+}
+
+// Producer and consumer stream through one SpscQueue; one iteration is one element.
+void BM_SpscThroughput(benchmark::State& state)
+{
+	SpscQueue<uint64_t> queue(QUEUE_CAPACITY);
+	std::atomic<bool> bDone(false);
+	std::thread consumer([&]
+	{
+		uint64_t value;
+		SpinWait wait{ WaitPolicy() };
+		while (!bDone.load(std::memory_order_acquire) || !queue.IsEmpty())
+		{
+			if (queue.TryDequeue(value))
+			{
+				benchmark::DoNotOptimize(value);
+			}
+			else
+			{
+				wait.SpinOnce();
+			}
+		}
+	});
+
+	uint64_t i = 0;
+	for (auto _ : state)
+	{
+		spinEnqueue(queue, i++);
+	}
+	bDone.store(true, std::memory_order_release);
+	consumer.join();
+	state.SetItemsProcessed(state.iterations());
+}
+
+// Every thread enqueues and then dequeues one element per iteration on a shared
+// queue, so the queue never holds more elements than there are threads.
+template <typename Q>
+void BM_Contention(benchmark::State& state)
+{
+	static Q* queue;
+	if (state.thread_index() == 0)
+	{
+		queue = makeQueue<Q>();
+	}
+
+	uint64_t i = 0;
+	uint64_t value;
+	for (auto _ : state)
+	{
+		queue->Enqueue(i++);
+		queue->Dequeue(value);
+		benchmark::DoNotOptimize(value);
+	}
+
+	if (state.thread_index() == 0)
+	{
+		delete queue;
+	}
+	state.SetItemsProcessed(state.iterations() * 2);
+}
+
+// Same pattern for priority queues; a relaxed pop may come back empty while
+// other threads hold the elements.
+template <typename Q>
+void BM_PriorityContention(benchmark::State& state)
+{
+	static Q* queue;
+	if (state.thread_index() == 0)
+	{
+		queue = makeQueue<Q>();
+	}
+
+	uint64_t i = static_cast<uint64_t>(state.thread_index()) << 40;
+	uint64_t value;
+	for (auto _ : state)
+	{
+		queue->Enqueue(i++);
+		benchmark::DoNotOptimize(queue->TryPop(value));
+	}
+
+	if (state.thread_index() == 0)
+	{
+		delete queue;
+	}
+	state.SetItemsProcessed(state.iterations() * 2);
+}
+
+// Pops every element of a ConcurrentPriorityQueue with range(0) shards from one
+// thread and reports how many better elements were still queued at each pop.
+void BM_ConcurrentPriorityQueueRankError(benchmark::State& state)
+{
+	constexpr size_t n = size_t(1) << 16;
+	size_t shardCount = static_cast<size_t>(state.range(0));
+	std::vector<uint64_t> values = MakeShuffledValues<uint64_t>(n);
+
+	double totalError = 0;
+	size_t maxError = 0;
+	for (auto _ : state)
+	{
+		ConcurrentPriorityQueue<uint64_t> queue(shardCount);
+		for (uint64_t value : values)
+		{
+			queue.Enqueue(value);
+		}
+
+		// Fenwick tree over the keys still queued.
+		std::vector<uint32_t> tree(n + 1);
+		for (size_t key = 1; key <= n; ++key)
+		{
+			for (size_t j = key; j <= n; j += j & (0 - j))
+			{
+				++tree[j];
+			}
+		}
+
+		size_t remaining = n;
+		uint64_t value;
+		while (queue.TryPop(value))
+		{
+			size_t notGreater = 0;
+			for (size_t j = value + 1; j > 0; j -= j & (0 - j))
+			{
+				notGreater += tree[j];
+			}
+			size_t error = remaining - notGreater;
+			totalError += static_cast<double>(error);
+			maxError = std::max(maxError, error);
+			for (size_t j = value + 1; j <= n; j += j & (0 - j))
+			{
+				--tree[j];
+			}
+			--remaining;
+		}
+	}
+
+	state.counters["mean_rank_error"] = totalError / static_cast<double>(state.iterations() * n);
+	state.counters["max_rank_error"] = static_cast<double>(maxError);
+	state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * n));
+}
+
+// Levels of the task tree that BM_ForkJoin runs per iteration.
+constexpr uint32_t FORK_JOIN_DEPTH = 18;
+
+// Runs a binary task tree on range(0) threads, each owning a deque D. A task of
+// depth d forks a child of depth d - 1 onto its thread's deque and continues as
+// the other child, down to a leaf; a thread that runs dry steals from random
+// victims. One iteration is one complete tree, started on the benchmark thread.
+template <typename D>
+void BM_ForkJoin(benchmark::State& state)
+{
+	size_t threadCount = static_cast<size_t>(state.range(0));
+	std::vector<std::unique_ptr<D>> deques;
+	for (size_t i = 0; i < threadCount; ++i)
+	{
+		deques.push_back(std::make_unique<D>());
+	}
+
+	// Leaves of the current tree not yet run. Threads report theirs in batches.
+	std::atomic<uint64_t> remaining(0);
+	std::atomic<uint64_t> generation(0);
+	std::atomic<size_t> finished(0);
+	std::atomic<bool> bStop(false);
+
+	auto run = [&](size_t self, std::mt19937& rng)
+	{
+		D& own = *deques[self];
+		uint64_t leaves = 0;
+		uint32_t depth;
+		SpinWait wait{ WaitPolicy() };
+		while (remaining.load(std::memory_order_acquire) > 0)
+		{
+			if (own.TryPop(depth) || deques[rng() % threadCount]->TrySteal(depth))
+			{
+				for (; depth > 0; --depth)
+				{
+					own.Push(depth - 1);
+				}
+				++leaves;
+				wait = SpinWait{ WaitPolicy() };
+			}
+			else if (leaves > 0)
+			{
+				remaining.fetch_sub(leaves, std::memory_order_acq_rel);
+				leaves = 0;
+			}
+			else
+			{
+				wait.SpinOnce();
+			}
+		}
+	};
+
+	std::vector<std::thread> workers;
+	for (size_t i = 1; i < threadCount; ++i)
+	{
+		workers.emplace_back([&, i]
+		{
+			std::mt19937 rng(static_cast<uint32_t>(i));
+			uint64_t seen = 0;
+			for (;;)
+			{
+				SpinWait wait{ WaitPolicy() };
+				while (generation.load(std::memory_order_acquire) == seen && !bStop.load(std::memory_order_acquire))
+				{
+					wait.SpinOnce();
+				}
+				if (bStop.load(std::memory_order_acquire))
+				{
+					return;
+				}
+				++seen;
+				run(i, rng);
+				finished.fetch_add(1, std::memory_order_acq_rel);
+			}
+		});
+	}
+
+	std::mt19937 rng(0);
+	for (auto _ : state)
+	{
+		remaining.store(uint64_t(1) << FORK_JOIN_DEPTH, std::memory_order_relaxed);
+		deques[0]->Push(FORK_JOIN_DEPTH);
+		generation.fetch_add(1, std::memory_order_release);
+		run(0, rng);
+
+		SpinWait wait{ WaitPolicy() };
+		while (finished.load(std::memory_order_acquire) != threadCount - 1)
+		{
+			wait.SpinOnce();
+		}
+		finished.store(0, std::memory_order_relaxed);
+	}
+
+	bStop.store(true, std::memory_order_release);
+	for (std::thread& worker : workers)
+	{
+		worker.join();
+	}
+	state.SetItemsProcessed(static_cast<int64_t>(state.iterations() << FORK_JOIN_DEPTH));
+}
+
+BENCHMARK(BM_SpscRoundTrip)->UseRealTime();
+BENCHMARK(BM_SpscThroughput)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Contention, MpmcQueue<uint64_t>)->ThreadRange(1, 64)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Contention, LockedQueue)->ThreadRange(1, 64)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_PriorityContention, ConcurrentPriorityQueue<uint64_t>)->ThreadRange(1, 64)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_PriorityContention, LockedPriorityQueue)->ThreadRange(1, 64)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_ForkJoin, WorkStealingDeque<uint32_t>)->ArgName("threads")->RangeMultiplier(2)->Range(1, 64)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_ForkJoin, LockedStack)->ArgName("threads")->RangeMultiplier(2)->Range(1, 64)->UseRealTime();
+BENCHMARK(BM_ConcurrentPriorityQueueRankError)->ArgName("shards")->RangeMultiplier(2)->Range(1, 64);
+
+} // namespace
+} // namespace abouttt
@@ -0,0 +1,320 @@
+#include <algorithm>
+#include <list>
+#include <vector>
+
+#include "BenchmarkUtils.h"
+#include "IntrusiveLinkedList.h"
+#include "LinkedList.h"
+#include "UnrolledLinkedList.h"
+
+namespace abouttt
+{
+namespace
+{
+
+template <typename T>
+struct IntrusiveItem : IntrusiveListHook<>
+{
+	explicit IntrusiveItem(const T& value)
+		: mValue(value)
+	{
+	}
+
+	T mValue;
+};
+
+template <typename T>
+std::vector<IntrusiveItem<T>> makeItems(size_t count)
+{
+	std::vector<IntrusiveItem<T>> items;
+	items.reserve(count);
+	for (size_t i = 0; i < count; ++i)
+	{
+		items.emplace_back(MakeValue<T>(i));
+	}
+	return items;
+}
+
+template <typename C, typename T>
+C makeList(const std::vector<T>& values)
+{
+	C c;
+	for (const T& value : values)
+	{
+		c.AddTail(value);
+	}
+	return c;
+}
+
+// Append n elements, then pop them all from the front.
+template <typename T>
+void BM_PushPop_LinkedList(benchmark::State& state)
+{
+	size_t n = static_cast<size_t>(state.range(0));
+	std::vector<T> values = MakeValues<T>(n);
+	LinkedList<T> c;
+	for (auto _ : state)
+	{
+		for (const T& value : values)
+		{
+			c.AddTail(value);
+		}
+		for (size_t i = 0; i < n; ++i)
+		{
+			c.Remove(c.Head());
+		}
+		benchmark::ClobberMemory();
+	}
+	SetProcessed(state, 2 * n, sizeof(T));
+}
+
+template <typename T>
+void BM_PushPop_StdList(benchmark::State& state)
+{
+	size_t n = static_cast<size_t>(state.range(0));
+	std::vector<T> values = MakeValues<T>(n);
+	std::list<T> c;
+	for (auto _ : state)
+	{
+		for (const T& value : values)
+		{
+			c.push_back(value);
+		}
+		for (size_t i = 0; i < n; ++i)
+		{
+			c.pop_front();
+		}
+		benchmark::ClobberMemory();
+	}
+	SetProcessed(state, 2 * n, sizeof(T));
+}
+
+template <typename T>
+void BM_PushPop_UnrolledLinkedList(benchmark::State& state)
+{
+	size_t n = static_cast<size_t>(state.range(0));
+	std::vector<T> values = MakeValues<T>(n);
+	UnrolledLinkedList<T> c;
+	for (auto _ : state)
+	{
+		for (const T& value : values)
+		{
+			c.AddTail(value);
+		}
+		for (size_t i = 0; i < n; ++i)
+		{
+			c.Remove(c.begin());
+		}
+		benchmark::ClobberMemory();
+	}
+	SetProcessed(state, 2 * n, sizeof(T));
+}
+
+// Links and unlinks n objects that already exist; nothing is allocated.
+template <typename T>
+void BM_PushPop_IntrusiveLinkedList(benchmark::State& state)
+{
+	size_t n = static_cast<size_t>(state.range(0));
+	std::vector<IntrusiveItem<T>> items = makeItems<T>(n);
+	IntrusiveLinkedList<IntrusiveItem<T>> c;
+	for (auto _ : state)
+	{
+		for (IntrusiveItem<T>& item : items)
+		{
+			c.AddTail(item);
+		}
+		for (size_t i = 0; i < n; ++i)
+		{
+			c.PopHead();
+		}
+		benchmark::ClobberMemory();
+	}
+	SetProcessed(state, 2 * n, sizeof(T));
+}
+
+// One insert and one erase next to a node in the middle of n elements.
+template <typename T>
+void BM_InsertErase_LinkedList(benchmark::State& state)
+{
+	size_t n = static_cast<size_t>(state.range(0));
+	LinkedList<T> c = makeList<LinkedList<T>>(MakeValues<T>(n));
+	LinkedListNode<T>* middle = c.Find(MakeValue<T>(n / 2));
+	T value = MakeValue<T>(n);
+	for (auto _ : state)
+	{
+		c.Insert(value, middle);
+		c.Remove(middle->Prev());
+		benchmark::ClobberMemory();
+	}
+	SetProcessed(state, 2, sizeof(T));
+}
+
+template <typename T>
+void BM_InsertErase_StdList(benchmark::State& state)
+{
+	size_t n = static_cast<size_t>(state.range(0));
+	std::vector<T> values = MakeValues<T>(n);
+	std::list<T> c(values.begin(), values.end());
+	auto middle = std::find(c.begin(), c.end(), MakeValue<T>(n / 2));
+	T value = MakeValue<T>(n);
+	for (auto _ : state)
+	{
+		c.erase(c.insert(middle, value));
+		benchmark::ClobberMemory();
+	}
+	SetProcessed(state, 2, sizeof(T));
+}
+
+template <typename T>
+void BM_InsertErase_UnrolledLinkedList(benchmark::State& state)
+{
+	size_t n = static_cast<size_t>(state.range(0));
+	UnrolledLinkedList<T> c = makeList<UnrolledLinkedList<T>>(MakeValues<T>(n));
+	auto middle = c.Find(MakeValue<T>(n / 2));
+	T value = MakeValue<T>(n);
+	for (auto _ : state)
+	{
+		// Remove returns the element after the removed one, which is middle again.
+		middle = c.Remove(c.Insert(middle, value));
+		benchmark::ClobberMemory();
+	}
+	SetProcessed(state, 2, sizeof(T));
+}
+
+// Linear search for a missing value.
+template <typename T>
+void BM_Find_LinkedList(benchmark::State& state)
+{
+	size_t n = static_cast<size_t>(state.range(0));
+	LinkedList<T> c = makeList<LinkedList<T>>(MakeValues<T>(n));
+	T missing = MakeValue<T>(n);
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(c.Find(missing));
+	}
+	SetProcessed(state, n, sizeof(T));
+}
+
+template <typename T>
+void BM_Find_StdList(benchmark::State& state)
+{
+	size_t n = static_cast<size_t>(state.range(0));
+	std::vector<T> values = MakeValues<T>(n);
+	std::list<T> c(values.begin(), values.end());
+	T missing = MakeValue<T>(n);
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(std::find(c.begin(), c.end(), missing));
+	}
+	SetProcessed(state, n, sizeof(T));
+}
+
+template <typename T>
+void BM_Find_UnrolledLinkedList(benchmark::State& state)
+{
+	size_t n = static_cast<size_t>(state.range(0));
+	UnrolledLinkedList<T> c = makeList<UnrolledLinkedList<T>>(MakeValues<T>(n));
+	T missing = MakeValue<T>(n);
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(c.Find(missing));
+	}
+	SetProcessed(state, n, sizeof(T));
+}
+
+template <typename T>
+void BM_Iterate_LinkedList(benchmark::State& state)
+{
+	size_t n = static_cast<size_t>(state.range(0));
+	LinkedList<T> c = makeList<LinkedList<T>>(MakeValues<T>(n));
+	for (auto _ : state)
+	{
+		size_t sum = 0;
+		for (const T& value : c)
+		{
+			sum += Weight(value);
+		}
+		benchmark::DoNotOptimize(sum);
+	}
+	SetProcessed(state, n, sizeof(T));
+}
+
+template <typename T>
+void BM_Iterate_StdList(benchmark::State& state)
+{
+	size_t n = static_cast<size_t>(state.range(0));
+	std::vector<T> values = MakeValues<T>(n);
+	std::list<T> c(values.begin(), values.end());
+	for (auto _ : state)
+	{
+		size_t sum = 0;
+		for (const T& value : c)
+		{
+			sum += Weight(value);
+		}
+		benchmark::DoNotOptimize(sum);
+	}
+	SetProcessed(state, n, sizeof(T));
+}
+
+template <typename T>
+void BM_Iterate_UnrolledLinkedList(benchmark::State& state)
+{
+	size_t n = static_cast<size_t>(state.range(0));
+	UnrolledLinkedList<T> c = makeList<UnrolledLinkedList<T>>(MakeValues<T>(n));
+	for (auto _ : state)
+	{
+		size_t sum = 0;
+		for (const T& value : c)
+		{
+			sum += Weight(value);
+		}
+		benchmark::DoNotOptimize(sum);
+	}
+	SetProcessed(state, n, sizeof(T));
+}
+
+template <typename T>
+void BM_Iterate_IntrusiveLinkedList(benchmark::State& state)
+{
+	size_t n = static_cast<size_t>(state.range(0));
+	std::vector<IntrusiveItem<T>> items = makeItems<T>(n);
+	IntrusiveLinkedList<IntrusiveItem<T>> c;
+	for (IntrusiveItem<T>& item : items)
+	{
+		c.AddTail(item);
+	}
+	for (auto _ : state)
+	{
+		size_t sum = 0;
+		for (const IntrusiveItem<T>& item : c)
+		{
+			sum += Weight(item.mValue);
+		}
+		benchmark::DoNotOptimize(sum);
+	}
+	SetProcessed(state, n, sizeof(T));
+}
+
+#define ABOUTTT_LINKED_LIST_BENCHMARKS(T) \
+	BENCHMARK_TEMPLATE(BM_PushPop_LinkedList, T)->Apply(BenchmarkSizes<T>); \
+	BENCHMARK_TEMPLATE(BM_PushPop_StdList, T)->Apply(BenchmarkSizes<T>); \
+	BENCHMARK_TEMPLATE(BM_PushPop_UnrolledLinkedList, T)->Apply(BenchmarkSizes<T>); \
+	BENCHMARK_TEMPLATE(BM_PushPop_IntrusiveLinkedList, T)->Apply(BenchmarkSizes<T>); \
+	BENCHMARK_TEMPLATE(BM_InsertErase_LinkedList, T)->Apply(BenchmarkSizes<T>); \
+	BENCHMARK_TEMPLATE(BM_InsertErase_StdList, T)->Apply(BenchmarkSizes<T>); \
+	BENCHMARK_TEMPLATE(BM_InsertErase_UnrolledLinkedList, T)->Apply(BenchmarkSizes<T>); \
+	BENCHMARK_TEMPLATE(BM_Find_LinkedList, T)->Apply(BenchmarkSizes<T>); \
+	BENCHMARK_TEMPLATE(BM_Find_StdList, T)->Apply(BenchmarkSizes<T>); \
+	BENCHMARK_TEMPLATE(BM_Find_UnrolledLinkedList, T)->Apply(BenchmarkSizes<T>); \
+	BENCHMARK_TEMPLATE(BM_Iterate_LinkedList, T)->Apply(BenchmarkSizes<T>); \
+	BENCHMARK_TEMPLATE(BM_Iterate_StdList, T)->Apply(BenchmarkSizes<T>); \
+	BENCHMARK_TEMPLATE(BM_Iterate_UnrolledLinkedList, T)->Apply(BenchmarkSizes<T>); \
+	BENCHMARK_TEMPLATE(BM_Iterate_IntrusiveLinkedList, T)->Apply(BenchmarkSizes<T>)
+
+ABOUTTT_LINKED_LIST_BENCHMARKS(Small);
+ABOUTTT_LINKED_LIST_BENCHMARKS(Medium);
+ABOUTTT_LINKED_LIST_BENCHMARKS(String);
+
+} // namespace
+} // namespace abouttt
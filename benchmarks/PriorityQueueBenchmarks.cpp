@@ -0,0 +1,265 @@
+#include <filesystem>
+#include <functional>
+#include <queue>
+#include <string>
+#include <vector>
+
+#include "BenchmarkUtils.h"
+#include "IndexedPriorityQueue.h"
+#include "PriorityQueue.h"
+#include "RadixPriorityQueue.h"
+#include "Snapshot.h"
+
+namespace abouttt
+{
+namespace
+{
+
+template <typename T, size_t Arity>
+using AryPriorityQueue = PriorityQueue<T, std::less<T>, std::allocator<T>, Arity>;
+
+template <typename C>
+struct PriorityQueueTraits;
+
+template <typename T, typename Compare, typename Allocator, size_t Arity, typename Growth>
+struct PriorityQueueTraits<PriorityQueue<T, Compare, Allocator, Arity, Growth>>
+{
+	using C = PriorityQueue<T, Compare, Allocator, Arity, Growth>;
+	using ValueType = T;
+
+	static void Build(C& c, const std::vector<T>& values)
+	{
+		c.EnqueueRange(values.begin(), values.end());
+	}
+
+	static void Pop(C& c)
+	{
+		c.Dequeue();
+	}
+
+	static void Push(C& c, const T& value)
+	{
+		c.Enqueue(value);
+	}
+
+	static void Reserve(C& c, size_t count)
+	{
+		c.Reserve(count);
+	}
+
+	static void Restart(C&)
+	{
+	}
+};
+
+template <typename T, typename Compare, typename Allocator, size_t Arity>
+struct PriorityQueueTraits<IndexedPriorityQueue<T, Compare, Allocator, Arity>>
+{
+	using C = IndexedPriorityQueue<T, Compare, Allocator, Arity>;
+	using ValueType = T;
+
+	static void Build(C& c, const std::vector<T>& values)
+	{
+		for (const T& value : values)
+		{
+			c.Enqueue(value);
+		}
+	}
+
+	static void Pop(C& c)
+	{
+		c.Dequeue();
+	}
+
+	static void Push(C& c, const T& value)
+	{
+		c.Enqueue(value);
+	}
+
+	static void Reserve(C& c, size_t count)
+	{
+		c.Reserve(count);
+	}
+
+	static void Restart(C&)
+	{
+	}
+};
+
+// Keys double as values; RadixPriorityQueue pops the smallest key first.
+template <typename Key, typename Allocator>
+struct PriorityQueueTraits<RadixPriorityQueue<Key, Key, Allocator>>
+{
+	using C = RadixPriorityQueue<Key, Key, Allocator>;
+	using ValueType = Key;
+
+	static void Build(C& c, const std::vector<Key>& values)
+	{
+		for (Key value : values)
+		{
+			c.Enqueue(value, value);
+		}
+	}
+
+	static void Pop(C& c)
+	{
+		c.Dequeue();
+	}
+
+	static void Push(C& c, Key value)
+	{
+		c.Enqueue(value, value);
+	}
+
+	static void Reserve(C&, size_t)
+	{
+	}
+
+	// Clearing lowers the minimum key back to zero for the next iteration.
+	static void Restart(C& c)
+	{
+		c.Clear();
+	}
+};
+
+template <typename T, typename Compare>
+struct PriorityQueueTraits<std::priority_queue<T, std::vector<T>, Compare>>
+{
+	using C = std::priority_queue<T, std::vector<T>, Compare>;
+	using ValueType = T;
+
+	static void Build(C& c, const std::vector<T>& values)
+	{
+		c = C(values.begin(), values.end());
+	}
+
+	static void Pop(C& c)
+	{
+		c.pop();
+	}
+
+	static void Push(C& c, const T& value)
+	{
+		c.push(value);
+	}
+
+	static void Reserve(C&, size_t)
+	{
+	}
+
+	static void Restart(C&)
+	{
+	}
+};
+
+// Enqueue n shuffled elements into reserved storage, then dequeue them all.
+template <typename C>
+void BM_PushPop(benchmark::State& state)
+{
+	using Traits = PriorityQueueTraits<C>;
+	using T = typename Traits::ValueType;
+	size_t n = static_cast<size_t>(state.range(0));
+	std::vector<T> values = MakeShuffledValues<T>(n);
+	C c;
+	Traits::Reserve(c, n);
+	for (auto _ : state)
+	{
+		for (const T& value : values)
+		{
+			Traits::Push(c, value);
+		}
+		for (size_t i = 0; i < n; ++i)
+		{
+			Traits::Pop(c);
+		}
+		Traits::Restart(c);
+		benchmark::ClobberMemory();
+	}
+	SetProcessed(state, 2 * n, sizeof(T));
+}
+
+// Builds a heap of n shuffled elements in one go.
+template <typename C>
+void BM_Build(benchmark::State& state)
+{
+	using Traits = PriorityQueueTraits<C>;
+	using T = typename Traits::ValueType;
+	size_t n = static_cast<size_t>(state.range(0));
+	std::vector<T> values = MakeShuffledValues<T>(n);
+	for (auto _ : state)
+	{
+		C c;
+		Traits::Build(c, values);
+		benchmark::DoNotOptimize(&c);
+	}
+	SetProcessed(state, n, sizeof(T));
+}
+
+// Enqueue n shuffled elements into an empty queue, paying for every reallocation.
+template <typename C>
+void BM_Grow(benchmark::State& state)
+{
+	using Traits = PriorityQueueTraits<C>;
+	using T = typename Traits::ValueType;
+	size_t n = static_cast<size_t>(state.range(0));
+	std::vector<T> values = MakeShuffledValues<T>(n);
+	for (auto _ : state)
+	{
+		C c;
+		for (const T& value : values)
+		{
+			Traits::Push(c, value);
+		}
+		benchmark::DoNotOptimize(&c);
+	}
+	SetProcessed(state, n, sizeof(T));
+}
+
+// Maps a snapshot of a heap of n shuffled elements, including the checksum pass,
+// and reads its top. Compare with BM_Build, which rebuilds the heap from values.
+template <typename T>
+void BM_LoadSnapshot(benchmark::State& state)
+{
+	size_t n = static_cast<size_t>(state.range(0));
+	std::vector<T> values = MakeShuffledValues<T>(n);
+	std::string path = (std::filesystem::temp_directory_path() / "abouttt_priority_queue.snapshot").string();
+	{
+		PriorityQueue<T> source(values.begin(), values.end());
+		WriteSnapshot(path.c_str(), source);
+	}
+	for (auto _ : state)
+	{
+		auto c = MapPriorityQueue<T>(path.c_str());
+		benchmark::DoNotOptimize(c.Peek());
+	}
+	std::filesystem::remove(path);
+	SetProcessed(state, n, sizeof(T));
+}
+
+#define ABOUTTT_PRIORITY_QUEUE_BENCHMARKS(T) \
+	BENCHMARK_TEMPLATE(BM_PushPop, AryPriorityQueue<T, 2>)->Apply(BenchmarkSizes<T>); \
+	BENCHMARK_TEMPLATE(BM_PushPop, AryPriorityQueue<T, 4>)->Apply(BenchmarkSizes<T>); \
+	BENCHMARK_TEMPLATE(BM_PushPop, AryPriorityQueue<T, 8>)->Apply(BenchmarkSizes<T>); \
+	BENCHMARK_TEMPLATE(BM_PushPop, IndexedPriorityQueue<T>)->Apply(BenchmarkSizes<T>); \
+	BENCHMARK_TEMPLATE(BM_PushPop, std::priority_queue<T>)->Apply(BenchmarkSizes<T>); \
+	BENCHMARK_TEMPLATE(BM_Build, AryPriorityQueue<T, 2>)->Apply(BenchmarkSizes<T>); \
+	BENCHMARK_TEMPLATE(BM_Build, AryPriorityQueue<T, 4>)->Apply(BenchmarkSizes<T>); \
+	BENCHMARK_TEMPLATE(BM_Build, std::priority_queue<T>)->Apply(BenchmarkSizes<T>); \
+	BENCHMARK_TEMPLATE(BM_Grow, AryPriorityQueue<T, 2>)->Apply(BenchmarkSizes<T>); \
+	BENCHMARK_TEMPLATE(BM_Grow, std::priority_queue<T>)->Apply(BenchmarkSizes<T>)
+
+ABOUTTT_PRIORITY_QUEUE_BENCHMARKS(Small);
+ABOUTTT_PRIORITY_QUEUE_BENCHMARKS(Medium);
+ABOUTTT_PRIORITY_QUEUE_BENCHMARKS(String);
+
+using RadixQueue = RadixPriorityQueue<uint32_t, uint32_t>;
+using MinQueue = std::priority_queue<uint32_t, std::vector<uint32_t>, std::greater<uint32_t>>;
+
+BENCHMARK_TEMPLATE(BM_PushPop, RadixQueue)->Apply(BenchmarkSizes<uint32_t>);
+BENCHMARK_TEMPLATE(BM_PushPop, MinQueue)->Apply(BenchmarkSizes<uint32_t>);
+
+BENCHMARK_TEMPLATE(BM_LoadSnapshot, Small)->Apply(BenchmarkSizes<Small>);
+BENCHMARK_TEMPLATE(BM_LoadSnapshot, Medium)->Apply(BenchmarkSizes<Medium>);
+
+} // namespace
+} // namespace abouttt
@@ -0,0 +1,223 @@
+#include <algorithm>
+#include <deque>
+#include <vector>
+
+#include "BenchmarkUtils.h"
+#include "ChunkedQueue.h"
+#include "Queue.h"
+
+namespace abouttt
+{
+namespace
+{
+
+// std::queue exposes neither search nor Reserve, so its default underlying
+// container stands in for it.
+template <typename C>
+struct QueueTraits;
+
+template <typename T, typename Allocator, bool bPowerOfTwo, typename Growth>
+struct QueueTraits<Queue<T, Allocator, bPowerOfTwo, Growth>>
+{
+	using C = Queue<T, Allocator, bPowerOfTwo, Growth>;
+	using ValueType = T;
+
+	static bool Contains(const C& c, const T& value)
+	{
+		return c.Contains(value);
+	}
+
+	static void Pop(C& c)
+	{
+		c.Dequeue();
+	}
+
+	static void Push(C& c, const T& value)
+	{
+		c.Enqueue(value);
+	}
+
+	static void Reserve(C& c, size_t count)
+	{
+		c.Reserve(count);
+	}
+};
+
+template <typename T, typename Allocator, size_t BlockSize, size_t MaxFreeBlocks>
+struct QueueTraits<ChunkedQueue<T, Allocator, BlockSize, MaxFreeBlocks>>
+{
+	using C = ChunkedQueue<T, Allocator, BlockSize, MaxFreeBlocks>;
+	using ValueType = T;
+
+	static bool Contains(const C& c, const T& value)
+	{
+		return c.Contains(value);
+	}
+
+	static void Pop(C& c)
+	{
+		c.Dequeue();
+	}
+
+	static void Push(C& c, const T& value)
+	{
+		c.Enqueue(value);
+	}
+
+	static void Reserve(C& c, size_t count)
+	{
+		c.Reserve(count);
+	}
+};
+
+template <typename T>
+struct QueueTraits<std::deque<T>>
+{
+	using C = std::deque<T>;
+	using ValueType = T;
+
+	static bool Contains(const C& c, const T& value)
+	{
+		return std::find(c.begin(), c.end(), value) != c.end();
+	}
+
+	static void Pop(C& c)
+	{
+		c.pop_front();
+	}
+
+	static void Push(C& c, const T& value)
+	{
+		c.push_back(value);
+	}
+
+	static void Reserve(C&, size_t)
+	{
+	}
+};
+
+template <typename C>
+C makeFilled(const std::vector<typename QueueTraits<C>::ValueType>& values)
+{
+	C c;
+	QueueTraits<C>::Reserve(c, values.size());
+	for (const auto& value : values)
+	{
+		QueueTraits<C>::Push(c, value);
+	}
+	return c;
+}
+
+// Enqueue n elements into reserved storage, then dequeue them all.
+template <typename C>
+void BM_PushPop(benchmark::State& state)
+{
+	using Traits = QueueTraits<C>;
+	using T = typename Traits::ValueType;
+	size_t n = static_cast<size_t>(state.range(0));
+	std::vector<T> values = MakeValues<T>(n);
+	C c;
+	Traits::Reserve(c, n);
+	for (auto _ : state)
+	{
+		for (const T& value : values)
+		{
+			Traits::Push(c, value);
+		}
+		for (size_t i = 0; i < n; ++i)
+		{
+			Traits::Pop(c);
+		}
+		benchmark::ClobberMemory();
+	}
+	SetProcessed(state, 2 * n, sizeof(T));
+}
+
+// Steady state at n elements: every enqueue is paired with a dequeue, so the
+// indices keep wrapping around the ring.
+template <typename C>
+void BM_Cycle(benchmark::State& state)
+{
+	using Traits = QueueTraits<C>;
+	using T = typename Traits::ValueType;
+	size_t n = static_cast<size_t>(state.range(0));
+	std::vector<T> values = MakeValues<T>(n);
+	C c = makeFilled<C>(values);
+	for (auto _ : state)
+	{
+		for (const T& value : values)
+		{
+			Traits::Pop(c);
+			Traits::Push(c, value);
+		}
+		benchmark::ClobberMemory();
+	}
+	SetProcessed(state, 2 * n, sizeof(T));
+}
+
+// Enqueue n elements into an empty queue, paying for every reallocation.
+template <typename C>
+void BM_Grow(benchmark::State& state)
+{
+	using Traits = QueueTraits<C>;
+	using T = typename Traits::ValueType;
+	size_t n = static_cast<size_t>(state.range(0));
+	std::vector<T> values = MakeValues<T>(n);
+	for (auto _ : state)
+	{
+		C c;
+		for (const T& value : values)
+		{
+			Traits::Push(c, value);
+		}
+		benchmark::DoNotOptimize(&c);
+	}
+	SetProcessed(state, n, sizeof(T));
+}
+
+// Linear search for a missing value in a queue whose contents wrap around.
+template <typename C>
+void BM_Find(benchmark::State& state)
+{
+	using Traits = QueueTraits<C>;
+	using T = typename Traits::ValueType;
+	size_t n = static_cast<size_t>(state.range(0));
+	std::vector<T> values = MakeValues<T>(n);
+	C c = makeFilled<C>(values);
+	for (size_t i = 0; i < n / 2; ++i)
+	{
+		Traits::Pop(c);
+		Traits::Push(c, values[i]);
+	}
+	T missing = MakeValue<T>(n);
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(Traits::Contains(c, missing));
+	}
+	SetProcessed(state, n, sizeof(T));
+}
+
+#define ABOUTTT_QUEUE_BENCHMARKS(T) \
+	BENCHMARK_TEMPLATE(BM_PushPop, Queue<T>)->Apply(BenchmarkSizes<T>); \
+	BENCHMARK_TEMPLATE(BM_PushPop, PowerOfTwoQueue<T>)->Apply(BenchmarkSizes<T>); \
+	BENCHMARK_TEMPLATE(BM_PushPop, ChunkedQueue<T>)->Apply(BenchmarkSizes<T>); \
+	BENCHMARK_TEMPLATE(BM_PushPop, std::deque<T>)->Apply(BenchmarkSizes<T>); \
+	BENCHMARK_TEMPLATE(BM_Cycle, Queue<T>)->Apply(BenchmarkSizes<T>); \
+	BENCHMARK_TEMPLATE(BM_Cycle, PowerOfTwoQueue<T>)->Apply(BenchmarkSizes<T>); \
+	BENCHMARK_TEMPLATE(BM_Cycle, ChunkedQueue<T>)->Apply(BenchmarkSizes<T>); \
+	BENCHMARK_TEMPLATE(BM_Cycle, std::deque<T>)->Apply(BenchmarkSizes<T>); \
+	BENCHMARK_TEMPLATE(BM_Grow, Queue<T>)->Apply(BenchmarkSizes<T>); \
+	BENCHMARK_TEMPLATE(BM_Grow, PowerOfTwoQueue<T>)->Apply(BenchmarkSizes<T>); \
+	BENCHMARK_TEMPLATE(BM_Grow, ChunkedQueue<T>)->Apply(BenchmarkSizes<T>); \
+	BENCHMARK_TEMPLATE(BM_Grow, std::deque<T>)->Apply(BenchmarkSizes<T>); \
+	BENCHMARK_TEMPLATE(BM_Find, Queue<T>)->Apply(BenchmarkSizes<T>); \
+	BENCHMARK_TEMPLATE(BM_Find, PowerOfTwoQueue<T>)->Apply(BenchmarkSizes<T>); \
+	BENCHMARK_TEMPLATE(BM_Find, ChunkedQueue<T>)->Apply(BenchmarkSizes<T>); \
+	BENCHMARK_TEMPLATE(BM_Find, std::deque<T>)->Apply(BenchmarkSizes<T>)
+
+ABOUTTT_QUEUE_BENCHMARKS(Small);
+ABOUTTT_QUEUE_BENCHMARKS(Medium);
+ABOUTTT_QUEUE_BENCHMARKS(String);
+
+} // namespace
+} // namespace abouttt
@@ -0,0 +1,157 @@
+#include <algorithm>
+#include <vector>
+
+#include "BenchmarkUtils.h"
+#include "Stack.h"
+
+namespace abouttt
+{
+namespace
+{
+
+// std::stack exposes neither search nor reserve, so std::vector, the usual
+// choice of underlying container, stands in for it.
+template <typename C>
+struct StackTraits;
+
+template <typename T, typename Allocator, typename Growth>
+struct StackTraits<Stack<T, Allocator, Growth>>
+{
+	using C = Stack<T, Allocator, Growth>;
+	using ValueType = T;
+
+	static bool Contains(const C& c, const T& value)
+	{
+		return c.Contains(value);
+	}
+
+	static void Pop(C& c)
+	{
+		c.Pop();
+	}
+
+	static void Push(C& c, const T& value)
+	{
+		c.Push(value);
+	}
+
+	static void Reserve(C& c, size_t count)
+	{
+		c.Reserve(count);
+	}
+};
+
+template <typename T>
+struct StackTraits<std::vector<T>>
+{
+	using C = std::vector<T>;
+	using ValueType = T;
+
+	static bool Contains(const C& c, const T& value)
+	{
+		return std::find(c.begin(), c.end(), value) != c.end();
+	}
+
+	static void Pop(C& c)
+	{
+		c.pop_back();
+	}
+
+	static void Push(C& c, const T& value)
+	{
+		c.push_back(value);
+	}
+
+	static void Reserve(C& c, size_t count)
+	{
+		c.reserve(count);
+	}
+};
+
+template <typename C>
+C makeFilled(const std::vector<typename StackTraits<C>::ValueType>& values)
+{
+	C c;
+	StackTraits<C>::Reserve(c, values.size());
+	for (const auto& value : values)
+	{
+		StackTraits<C>::Push(c, value);
+	}
+	return c;
+}
+
+// Push n elements into reserved storage, then pop them all.
+template <typename C>
+void BM_PushPop(benchmark::State& state)
+{
+	using Traits = StackTraits<C>;
+	using T = typename Traits::ValueType;
+	size_t n = static_cast<size_t>(state.range(0));
+	std::vector<T> values = MakeValues<T>(n);
+	C c;
+	Traits::Reserve(c, n);
+	for (auto _ : state)
+	{
+		for (const T& value : values)
+		{
+			Traits::Push(c, value);
+		}
+		for (size_t i = 0; i < n; ++i)
+		{
+			Traits::Pop(c);
+		}
+		benchmark::ClobberMemory();
+	}
+	SetProcessed(state, 2 * n, sizeof(T));
+}
+
+// Push n elements onto an empty stack, paying for every reallocation.
+template <typename C>
+void BM_Grow(benchmark::State& state)
+{
+	using Traits = StackTraits<C>;
+	using T = typename Traits::ValueType;
+	size_t n = static_cast<size_t>(state.range(0));
+	std::vector<T> values = MakeValues<T>(n);
+	for (auto _ : state)
+	{
+		C c;
+		for (const T& value : values)
+		{
+			Traits::Push(c, value);
+		}
+		benchmark::DoNotOptimize(&c);
+	}
+	SetProcessed(state, n, sizeof(T));
+}
+
+// Linear search for a missing value.
+template <typename C>
+void BM_Find(benchmark::State& state)
+{
+	using Traits = StackTraits<C>;
+	using T = typename Traits::ValueType;
+	size_t n = static_cast<size_t>(state.range(0));
+	C c = makeFilled<C>(MakeValues<T>(n));
+	T missing = MakeValue<T>(n);
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(Traits::Contains(c, missing));
+	}
+	SetProcessed(state, n, sizeof(T));
+}
+
+#define ABOUTTT_STACK_BENCHMARKS(T) \
+	BENCHMARK_TEMPLATE(BM_PushPop, Stack<T>)->Apply(BenchmarkSizes<T>); \
+	BENCHMARK_TEMPLATE(BM_PushPop, std::vector<T>)->Apply(BenchmarkSizes<T>); \
+	BENCHMARK_TEMPLATE(BM_Grow, Stack<T>)->Apply(BenchmarkSizes<T>); \
+	BENCHMARK_TEMPLATE(BM_Grow, std::vector<T>)->Apply(BenchmarkSizes<T>); \
+	BENCHMARK_TEMPLATE(BM_Find, Stack<T>)->Apply(BenchmarkSizes<T>); \
+	BENCHMARK_TEMPLATE(BM_Find, std::vector<T>)->Apply(BenchmarkSizes<T>)
+
+ABOUTTT_STACK_BENCHMARKS(Small);
+ABOUTTT_STACK_BENCHMARKS(Medium);
+ABOUTTT_STACK_BENCHMARKS(String);
+
+} // namespace
+} // namespace abouttt